@@ -0,0 +1,123 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+
+#include "pch.h"
+#include "Arena.h"
+
+//..............................................................................
+
+void
+Arena::freeBlockList(BlockHdr* block) {
+	while (block) {
+		BlockHdr* next = block->m_next;
+		free(block);
+		block = next;
+	}
+}
+
+void
+Arena::clear() {
+	freeBlockList(m_blockList);
+	freeBlockList(m_freeBlockList);
+
+	m_blockList = NULL;
+	m_freeBlockList = NULL;
+	m_p = NULL;
+	m_end = NULL;
+	m_nextBlockSize = MinBlockSize;
+	m_blockCount = 0;
+	m_allocCount = 0;
+}
+
+void
+Arena::recycle(Arena* arena) {
+	BlockHdr* lists[] = { arena->m_blockList, arena->m_freeBlockList };
+
+	for (size_t i = 0; i < countof(lists); i++) {
+		while (lists[i]) {
+			BlockHdr* block = lists[i];
+			lists[i] = block->m_next;
+			block->m_next = m_freeBlockList;
+			m_freeBlockList = block;
+		}
+	}
+
+	arena->m_blockList = NULL;
+	arena->m_freeBlockList = NULL;
+	arena->clear();
+}
+
+void
+Arena::reset() {
+	while (m_blockList) {
+		BlockHdr* block = m_blockList;
+		m_blockList = block->m_next;
+		block->m_next = m_freeBlockList;
+		m_freeBlockList = block;
+	}
+
+	m_p = NULL;
+	m_end = NULL;
+	m_nextBlockSize = MinBlockSize;
+	m_blockCount = 0;
+	m_allocCount = 0;
+}
+
+void*
+Arena::allocateBlock(size_t size) {
+	// the header takes a whole alignment unit, so the payload stays aligned
+
+	size_t hdrSize = (sizeof(BlockHdr) + Alignment - 1) & ~(Alignment - 1);
+
+	// first fit among the recycled blocks; a recycled block becomes current
+	// even for oversized requests
+
+	BlockHdr** prev = &m_freeBlockList;
+	for (BlockHdr* block = m_freeBlockList; block; block = block->m_next) {
+		if (block->m_size < size) {
+			prev = &block->m_next;
+			continue;
+		}
+
+		*prev = block->m_next;
+		block->m_next = m_blockList;
+		m_blockList = block;
+		m_blockCount++;
+
+		char* p = (char*)block + hdrSize;
+		m_p = p + size;
+		m_end = p + block->m_size;
+		return p;
+	}
+
+	size_t blockSize = AXL_MAX(size, m_nextBlockSize);
+
+	BlockHdr* block = (BlockHdr*)malloc(hdrSize + blockSize);
+	block->m_next = m_blockList;
+	block->m_size = blockSize;
+	m_blockList = block;
+	m_blockCount++;
+
+	char* p = (char*)block + hdrSize;
+
+	if (size > m_nextBlockSize) // oversized; keep bumping in the current block
+		return p;
+
+	if (m_nextBlockSize < MaxBlockSize)
+		m_nextBlockSize *= 2;
+
+	m_p = p + size;
+	m_end = p + blockSize;
+	return p;
+}
+
+//..............................................................................
@@ -0,0 +1,113 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+
+#pragma once
+
+//..............................................................................
+
+// bump allocator for objects which all die together (module items and tables
+// of a unit); memory is only released as a whole. there is no per-object
+// bookkeeping, so objects with non-trivial destructors must be destructed
+// explicitly before clearing (or recycling) the arena
+
+class Arena {
+protected:
+	enum {
+		Alignment      = sizeof(uint64_t) * 2,
+		MinBlockSize   = 4 * 1024,
+		MaxBlockSize   = 64 * 1024, // larger requests get blocks of their own
+	};
+
+	struct BlockHdr {
+		BlockHdr* m_next;
+		size_t m_size;
+	};
+
+protected:
+	BlockHdr* m_blockList;
+	BlockHdr* m_freeBlockList; // recycled from other arenas
+	char* m_p;
+	char* m_end;
+	size_t m_nextBlockSize;
+	size_t m_blockCount;
+	size_t m_allocCount;
+
+public:
+	Arena() {
+		m_blockList = NULL;
+		m_freeBlockList = NULL;
+		m_p = NULL;
+		m_end = NULL;
+		m_nextBlockSize = MinBlockSize;
+		m_blockCount = 0;
+		m_allocCount = 0;
+	}
+
+	~Arena() {
+		clear();
+	}
+
+	size_t
+	getBlockCount() const {
+		return m_blockCount;
+	}
+
+	size_t
+	getAllocCount() const {
+		return m_allocCount;
+	}
+
+	// frees all the blocks, including the recycled ones
+
+	void
+	clear();
+
+	// takes over all the blocks of another arena for reuse; the other arena
+	// ends up empty (all of its objects must be dead by now)
+
+	void
+	recycle(Arena* arena);
+
+	// keeps all the blocks for reuse (all the objects must be dead by now)
+
+	void
+	reset();
+
+	void*
+	allocate(size_t size) {
+		size = (size + Alignment - 1) & ~(Alignment - 1);
+		m_allocCount++;
+
+		if ((size_t)(m_end - m_p) < size)
+			return allocateBlock(size);
+
+		void* p = m_p;
+		m_p += size;
+		return p;
+	}
+
+	template <typename T>
+	T*
+	construct() {
+		return new (allocate(sizeof(T))) T;
+	}
+
+protected:
+	void*
+	allocateBlock(size_t size);
+
+	static
+	void
+	freeBlockList(BlockHdr* block);
+};
+
+//..............................................................................
@@ -32,6 +32,18 @@ CmdLineParser::onSwitch(
 		m_cmdLine->m_sourceDirList.insertTail(value);
 		break;
 
+	case CmdLineSwitchKind_Recursive:
+		m_cmdLine->m_flags |= CmdLineFlag_Recursive;
+		break;
+
+	case CmdLineSwitchKind_Include:
+		m_cmdLine->m_includeList.insertTail(value);
+		break;
+
+	case CmdLineSwitchKind_Exclude:
+		m_cmdLine->m_excludeList.insertTail(value);
+		break;
+
 	case CmdLineSwitchKind_OutputFileName:
 		m_cmdLine->m_outputFileName = value;
 		break;
@@ -39,6 +51,56 @@ CmdLineParser::onSwitch(
 	case CmdLineSwitchKind_DoxygenFilter:
 		m_cmdLine->m_flags |= CmdLineFlag_DoxygenFilter;
 		break;
+
+	case CmdLineSwitchKind_DoxygenFilterServer:
+		m_cmdLine->m_flags |= CmdLineFlag_DoxygenFilter | CmdLineFlag_FilterServer;
+		m_cmdLine->m_socketPath = value;
+		break;
+
+	case CmdLineSwitchKind_DoxygenFilterClient:
+		m_cmdLine->m_flags |= CmdLineFlag_DoxygenFilter | CmdLineFlag_FilterClient;
+		m_cmdLine->m_socketPath = value;
+		break;
+
+	case CmdLineSwitchKind_JobCount:
+		m_cmdLine->m_jobCount = strtoul(value.sz(), NULL, 10);
+		break;
+
+	case CmdLineSwitchKind_Stats:
+		m_cmdLine->m_flags |= CmdLineFlag_Stats;
+		break;
+
+	case CmdLineSwitchKind_CacheDir:
+		m_cmdLine->m_cacheDir = value;
+		break;
+
+	case CmdLineSwitchKind_WriteIfChanged:
+		m_cmdLine->m_flags |= CmdLineFlag_WriteIfChanged;
+		break;
+
+	case CmdLineSwitchKind_Incremental:
+		m_cmdLine->m_flags |= CmdLineFlag_Incremental;
+		break;
+
+	case CmdLineSwitchKind_Watch:
+		m_cmdLine->m_flags |= CmdLineFlag_Watch | CmdLineFlag_Incremental;
+		break;
+
+	case CmdLineSwitchKind_BenchLexer:
+		m_cmdLine->m_flags |= CmdLineFlag_BenchLexer;
+		break;
+
+	case CmdLineSwitchKind_DocumentedOnly:
+		m_cmdLine->m_flags |= CmdLineFlag_DocumentedOnly;
+		break;
+
+	case CmdLineSwitchKind_DataTables:
+		m_cmdLine->m_flags |= CmdLineFlag_DataTables;
+		break;
+
+	case CmdLineSwitchKind_BenchParser:
+		m_cmdLine->m_flags |= CmdLineFlag_BenchParser;
+		break;
 	}
 
 	return true;
@@ -48,9 +110,23 @@ bool
 CmdLineParser::finalize() {
 	if (m_cmdLine->m_inputFileNameList.isEmpty() &&
 		m_cmdLine->m_sourceDirList.isEmpty()) {
-		if (!m_cmdLine->m_flags)
+		if (!(m_cmdLine->m_flags & ~(
+			CmdLineFlag_Stats |
+			CmdLineFlag_Recursive |
+			CmdLineFlag_WriteIfChanged |
+			CmdLineFlag_Incremental |
+			CmdLineFlag_Watch |
+			CmdLineFlag_BenchLexer |
+			CmdLineFlag_DocumentedOnly |
+			CmdLineFlag_DataTables
+		)))
 			m_cmdLine->m_flags = CmdLineFlag_Help;
 	} else {
+		if ((m_cmdLine->m_flags & CmdLineFlag_Watch) && (m_cmdLine->m_flags & CmdLineFlag_DoxygenFilter)) {
+			err::setFormatStringError("--watch can't be used in doxygen filter modes");
+			return false;
+		}
+
 		if (m_cmdLine->m_outputFileName.isEmpty() && (!(m_cmdLine->m_flags & CmdLineFlag_DoxygenFilter)))
 			m_cmdLine->m_outputFileName = g_defaultOutputFileName;
 	}
@@ -14,21 +14,38 @@
 //..............................................................................
 
 enum CmdLineFlag {
-	CmdLineFlag_Help          = 0x0001,
-	CmdLineFlag_Version       = 0x0002,
-	CmdLineFlag_DoxygenFilter = 0x0004,
+	CmdLineFlag_Help           = 0x0001,
+	CmdLineFlag_Version        = 0x0002,
+	CmdLineFlag_DoxygenFilter  = 0x0004,
+	CmdLineFlag_Stats          = 0x0008,
+	CmdLineFlag_Recursive      = 0x0010,
+	CmdLineFlag_FilterServer   = 0x0020,
+	CmdLineFlag_FilterClient   = 0x0040,
+	CmdLineFlag_WriteIfChanged = 0x0080,
+	CmdLineFlag_Incremental    = 0x0100,
+	CmdLineFlag_Watch          = 0x0200,
+	CmdLineFlag_BenchLexer     = 0x0400,
+	CmdLineFlag_DocumentedOnly = 0x0800,
+	CmdLineFlag_BenchParser    = 0x1000,
+	CmdLineFlag_DataTables     = 0x2000,
 };
 
 // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
 struct CmdLine {
 	uint_t m_flags;
+	size_t m_jobCount;
 	sl::String m_outputFileName;
+	sl::String m_socketPath;
+	sl::String m_cacheDir;
 	sl::BoxList<sl::String> m_sourceDirList;
+	sl::BoxList<sl::String> m_includeList;
+	sl::BoxList<sl::String> m_excludeList;
 	sl::BoxList<sl::String> m_inputFileNameList;
 
 	CmdLine() {
 		m_flags = 0;
+		m_jobCount = 1;
 	}
 };
 
@@ -43,8 +60,23 @@ enum CmdLineSwitchKind {
 	CmdLineSwitchKind_Help,
 	CmdLineSwitchKind_Version,
 	CmdLineSwitchKind_SourceDir,
+	CmdLineSwitchKind_Recursive,
+	CmdLineSwitchKind_Include,
+	CmdLineSwitchKind_Exclude,
 	CmdLineSwitchKind_OutputFileName,
 	CmdLineSwitchKind_DoxygenFilter,
+	CmdLineSwitchKind_DoxygenFilterServer,
+	CmdLineSwitchKind_DoxygenFilterClient,
+	CmdLineSwitchKind_JobCount,
+	CmdLineSwitchKind_Stats,
+	CmdLineSwitchKind_CacheDir,
+	CmdLineSwitchKind_WriteIfChanged,
+	CmdLineSwitchKind_Incremental,
+	CmdLineSwitchKind_Watch,
+	CmdLineSwitchKind_BenchLexer,
+	CmdLineSwitchKind_DocumentedOnly,
+	CmdLineSwitchKind_BenchParser,
+	CmdLineSwitchKind_DataTables,
 };
 
 // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
@@ -68,6 +100,24 @@ AXL_SL_BEGIN_CMD_LINE_SWITCH_TABLE(CmdLineSwitchTable, CmdLineSwitchKind)
 		"Add a directory with Lua source files (multiple allowed)"
 	)
 
+	AXL_SL_CMD_LINE_SWITCH_2(
+		CmdLineSwitchKind_Recursive,
+		"R", "recursive", NULL,
+		"Scan source directories recursively"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_Include,
+		"include", "<glob>",
+		"Parse files matching <glob> in source directories (default: *.lua, *.dox)"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_Exclude,
+		"exclude", "<glob>",
+		"Skip files and directories matching <glob> in source directories"
+	)
+
 	AXL_SL_CMD_LINE_SWITCH_2(
 		CmdLineSwitchKind_OutputFileName,
 		"o", "output", "<file>",
@@ -79,6 +129,78 @@ AXL_SL_BEGIN_CMD_LINE_SWITCH_TABLE(CmdLineSwitchTable, CmdLineSwitchKind)
 		"doxygen-filter", NULL,
 		"Doxygen filter mode (output C-like source)"
 	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_DoxygenFilterServer,
+		"doxygen-filter-server", "<socket>",
+		"Serve doxygen filter requests on a Unix socket"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_DoxygenFilterClient,
+		"doxygen-filter-client", "<socket>",
+		"Doxygen filter mode via a server (falls back to --doxygen-filter)"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH_2(
+		CmdLineSwitchKind_JobCount,
+		"j", "jobs", "<n>",
+		"Parse source files on <n> threads (0 = one per CPU)"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_Stats,
+		"stats", NULL,
+		"Print statistics to stderr"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_CacheDir,
+		"cache", "<dir>",
+		"Reuse parse results of unchanged source files cached in <dir>"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_WriteIfChanged,
+		"write-if-changed", NULL,
+		"Only replace output files whose contents changed (keeps mtimes)"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_Incremental,
+		"incremental", NULL,
+		"Only regenerate compounds affected by changed source files"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_Watch,
+		"watch", NULL,
+		"Keep running and regenerate output whenever source files change"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_DocumentedOnly,
+		"documented-only", NULL,
+		"Only generate documentation for documented items (and their members)"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_DataTables,
+		"data-tables", NULL,
+		"Don't parse fields of table constructors in undocumented statements"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_BenchLexer,
+		"bench-lexer", NULL,
+		"Measure lexer throughput on input files (scalar vs vectorized scans)"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_BenchParser,
+		"bench-parser", NULL,
+		"Measure parser throughput on long operator chains and input files"
+	)
 AXL_SL_END_CMD_LINE_SWITCH_TABLE()
 
 // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
@@ -0,0 +1,102 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "CompoundGenerator.h"
+#include "Module.h"
+#include "DependencyGraph.h"
+
+//..............................................................................
+
+void
+CompoundGenerator::addCompound(Variable* variable) {
+	Compound compound;
+	compound.m_variable = variable;
+	compound.m_result = false;
+	compound.m_isSkipped = false;
+	m_compoundArray.append(compound);
+}
+
+void
+CompoundGenerator::skipUpToDateCompounds(DependencyGraph* dependencyGraph) {
+	size_t count = m_compoundArray.getCount();
+	for (size_t i = 0; i < count; i++) {
+		Compound* compound = &m_compoundArray[i];
+		compound->m_isSkipped = !dependencyGraph->addCompound(compound->m_variable);
+	}
+}
+
+bool
+CompoundGenerator::generate(
+	const sl::StringRef& outputDir,
+	sl::String* indexXml,
+	size_t threadCount
+) {
+	if (!threadCount)
+		threadCount = g::getModule()->getSystemInfo()->m_processorCount;
+
+	size_t count = m_compoundArray.getCount();
+	if (threadCount > count)
+		threadCount = count;
+
+	m_outputDir = outputDir;
+	m_nextCompoundIdx = 0;
+
+	if (threadCount < 2) {
+		generateThreadFunc();
+	} else {
+		sl::List<GenerateThread> threadList;
+		for (size_t i = 0; i < threadCount; i++) {
+			GenerateThread* thread = new GenerateThread(this);
+			threadList.insertTail(thread);
+			thread->start();
+		}
+
+		sl::Iterator<GenerateThread> it = threadList.getHead();
+		for (; it; it++)
+			it->waitAndClose();
+	}
+
+	// report the first failed compound
+
+	for (size_t i = 0; i < count; i++) {
+		const Compound& compound = m_compoundArray[i];
+		if (!compound.m_isSkipped && !compound.m_result) {
+			err::setError(compound.m_error);
+			return false;
+		}
+
+		compound.m_variable->generateIndexEntry(indexXml);
+	}
+
+	return true;
+}
+
+void
+CompoundGenerator::generateThreadFunc() {
+	size_t count = m_compoundArray.getCount();
+
+	for (;;) {
+		size_t i = sys::atomicInc(&m_nextCompoundIdx) - 1;
+		if (i >= count)
+			break;
+
+		Compound* compound = &m_compoundArray[i];
+		if (compound->m_isSkipped)
+			continue;
+
+		compound->m_result = compound->m_variable->generateCompoundFile(m_outputDir);
+		if (!compound->m_result)
+			compound->m_error = err::getLastError();
+	}
+}
+
+//..............................................................................
@@ -0,0 +1,86 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+struct Variable;
+class DependencyGraph;
+
+//..............................................................................
+
+// once doxy blocks and refids are assigned, compound files of Lua classes are
+// independent of each other and can be generated on a pool of worker threads
+// (workers only read the module); index entries are written in the order in
+// which compounds were added, so the result doesn't depend on thread timing
+
+class CompoundGenerator {
+protected:
+	class GenerateThread:
+		public sys::ThreadImpl<GenerateThread>,
+		public sl::ListLink {
+	protected:
+		CompoundGenerator* m_generator;
+
+	public:
+		GenerateThread(CompoundGenerator* generator) {
+			m_generator = generator;
+		}
+
+		void
+		threadFunc() {
+			m_generator->generateThreadFunc();
+		}
+	};
+
+	struct Compound {
+		Variable* m_variable;
+		err::Error m_error;
+		bool m_result;
+		bool m_isSkipped; // up to date
+	};
+
+protected:
+	sl::String m_outputDir;
+	sl::Array<Compound> m_compoundArray;
+	volatile int32_t m_nextCompoundIdx;
+
+public:
+	CompoundGenerator() {
+		m_nextCompoundIdx = 0;
+	}
+
+	size_t
+	getCompoundCount() {
+		return m_compoundArray.getCount();
+	}
+
+	void
+	addCompound(Variable* variable);
+
+	// marks compounds whose files needn't be regenerated; index entries are
+	// still written for all of them
+
+	void
+	skipUpToDateCompounds(DependencyGraph* dependencyGraph);
+
+	bool
+	generate(
+		const sl::StringRef& outputDir,
+		sl::String* indexXml,
+		size_t threadCount = 1
+	);
+
+protected:
+	void
+	generateThreadFunc();
+};
+
+//..............................................................................
@@ -0,0 +1,231 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "DependencyGraph.h"
+#include "Module.h"
+#include "version.h"
+
+#if (_AXL_OS_POSIX)
+#	include <unistd.h>
+#endif
+
+//..............................................................................
+
+CompoundDeps::CompoundDeps() {
+	m_refIdHash = fnv1aHash(NULL, 0);
+	m_isVolatile = false;
+}
+
+void
+CompoundDeps::addFile(const sl::StringRef& fileName) {
+	if (!fileName.isEmpty())
+		m_fileNameSet.visit(fileName)->m_value = true;
+}
+
+void
+CompoundDeps::addItem(ModuleItem* item) {
+	addFile(item->getFileName());
+
+	if (item->m_isReferencedByName)
+		m_isVolatile = true;
+
+	const sl::String& refId = item->ensureDoxyBlock()->getRefId();
+	m_refIdHash = fnv1aHash(refId.sz(), refId.getLength() + 1, m_refIdHash);
+}
+
+//..............................................................................
+
+DependencyGraph::DependencyGraph() {
+	sl::String header = getHeader();
+	m_optionHash = fnv1aHash(header.cp(), header.getLength());
+	m_dirtyCount = 0;
+}
+
+sl::String
+DependencyGraph::getHeader() {
+	return sl::formatString("luadoxyxml-deps %d %s", FormatVersion, VERSION_STRING);
+}
+
+void
+DependencyGraph::addOption(const sl::StringRef& option) {
+	m_optionHash = fnv1aHash(option.cp(), option.getLength(), m_optionHash);
+	m_optionHash = fnv1aHash("\n", 1, m_optionHash);
+}
+
+void
+DependencyGraph::load(const sl::StringRef& outputDir) {
+	m_outputDir = outputDir;
+	m_prevEntryMap.clear();
+	m_prevGraph.clear();
+
+	sl::String fileName = getFileName();
+	FILE* file = fopen(fileName.sz(), "rb");
+	if (!file)
+		return;
+
+	char buffer[16 * 1024];
+	for (;;) {
+		size_t size = fread(buffer, 1, sizeof(buffer), file);
+		m_prevGraph.append(buffer, size);
+		if (size < sizeof(buffer))
+			break;
+	}
+
+	fclose(file);
+
+	// header line, then: <refid> \t <signature> \t <is-volatile> [\t <file>]*
+
+	sl::String header = getHeader();
+	const char* p = m_prevGraph.cp();
+	const char* end = m_prevGraph.getEnd();
+	const char* eol = (const char*)memchr(p, '\n', end - p);
+	if (!eol || sl::StringRef(p, eol - p) != header)
+		return;
+
+	for (p = eol + 1; p < end; p = eol + 1) {
+		eol = (const char*)memchr(p, '\n', end - p);
+		if (!eol)
+			break;
+
+		const char* tab = (const char*)memchr(p, '\t', eol - p);
+		if (!tab)
+			continue;
+
+		char* next;
+		Entry entry;
+		entry.m_signature = _strtoui64(tab + 1, &next, 16);
+		entry.m_isVolatile = next + 1 < eol && next[0] == '\t' && next[1] == '1';
+		m_prevEntryMap[sl::StringRef(p, tab - p)] = entry;
+	}
+}
+
+void
+DependencyGraph::addSourceFiles(Module* module) {
+	sl::ConstIterator<Unit> it = module->getUnitList().getHead();
+	for (; it; it++) {
+		sl::StringRef source = it->m_source.getSource();
+		m_fileHashMap[it->m_fileName] = fnv1aHash(source.cp(), source.getLength());
+	}
+}
+
+uint64_t
+DependencyGraph::calcSignature(CompoundDeps* deps) {
+	uint64_t signature = fnv1aHash(&deps->m_refIdHash, sizeof(deps->m_refIdHash), m_optionHash);
+
+	sl::StringHashTableIterator<bool> it = deps->m_fileNameSet.getHead();
+	for (; it; it++) {
+		uint64_t fileHash = m_fileHashMap.findValue(it->m_key, 0);
+		signature = fnv1aHash(it->m_key.sz(), it->m_key.getLength() + 1, signature);
+		signature = fnv1aHash(&fileHash, sizeof(fileHash), signature);
+	}
+
+	return signature;
+}
+
+bool
+DependencyGraph::addCompound(Variable* compound) {
+	m_compoundArray.append(compound);
+
+	CompoundDeps deps;
+	compound->collectCompoundDependencies(&deps);
+
+	const sl::String& refId = compound->m_doxyBlock->getRefId();
+	sl::StringHashTableIterator<Entry> it = m_prevEntryMap.find(refId);
+
+	bool isDirty =
+		!it ||
+		it->m_value.m_isVolatile ||
+		deps.m_isVolatile ||
+		it->m_value.m_signature != calcSignature(&deps) ||
+		!io::doesFileExist(m_outputDir + "/" + refId + ".xml");
+
+	if (isDirty)
+		m_dirtyCount++;
+
+	return isDirty;
+}
+
+bool
+DependencyGraph::save() {
+	sl::String graph = getHeader();
+	graph += '\n';
+
+	sl::StringHashTable<bool> refIdSet;
+
+	// collect dependencies again: members may have been looked up by name
+	// while generating
+
+	size_t count = m_compoundArray.getCount();
+	for (size_t i = 0; i < count; i++) {
+		Variable* compound = m_compoundArray[i];
+		const sl::String& refId = compound->m_doxyBlock->getRefId();
+		refIdSet[refId] = true;
+
+		CompoundDeps deps;
+		compound->collectCompoundDependencies(&deps);
+
+		graph.appendFormat(
+			"%s\t%016llx\t%d",
+			refId.sz(),
+			(unsigned long long)calcSignature(&deps),
+			deps.m_isVolatile
+		);
+
+		sl::StringHashTableIterator<bool> it = deps.m_fileNameSet.getHead();
+		for (; it; it++) {
+			graph += '\t';
+			graph += it->m_key;
+		}
+
+		graph += '\n';
+	}
+
+	sl::StringHashTableIterator<Entry> it = m_prevEntryMap.getHead();
+	for (; it; it++)
+		if (!refIdSet.findValue(it->m_key, false)) {
+			sl::String fileName = m_outputDir + "/" + it->m_key + ".xml";
+			remove(fileName.sz());
+		}
+
+#if (_AXL_OS_POSIX)
+	int processId = getpid();
+#else
+	int processId = GetCurrentProcessId();
+#endif
+
+	sl::String fileName = getFileName();
+	sl::String tempFileName = sl::formatString("%s.%d.tmp", fileName.sz(), processId);
+
+	FILE* file = fopen(tempFileName.sz(), "wb");
+	if (!file) {
+		err::setFormatStringError("error writing %s", fileName.sz());
+		return false;
+	}
+
+	bool result = fwrite(graph.cp(), 1, graph.getLength(), file) == graph.getLength();
+	result = fclose(file) == 0 && result;
+
+#if (_AXL_OS_WIN)
+	if (result)
+		remove(fileName.sz());
+#endif
+
+	if (!result || rename(tempFileName.sz(), fileName.sz()) != 0) {
+		err::setFormatStringError("error writing %s", fileName.sz());
+		remove(tempFileName.sz());
+		return false;
+	}
+
+	return true;
+}
+
+//..............................................................................
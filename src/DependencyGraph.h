@@ -0,0 +1,117 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+class Module;
+struct ModuleItem;
+struct Variable;
+
+//..............................................................................
+
+// XML of a Lua class compound depends on the source files of the class itself,
+// its members (methods may be declared in other files) and its base types, and
+// also on refids of everything it references (refids of unchanged items may
+// still shift if a colliding name is added elsewhere)
+
+struct CompoundDeps {
+	sl::StringHashTable<bool> m_fileNameSet; // iterated in the order of addition
+	uint64_t m_refIdHash;
+	bool m_isVolatile; // has members documented or referenced by name from anywhere
+
+	CompoundDeps();
+
+	void
+	addFile(const sl::StringRef& fileName);
+
+	void
+	addItem(ModuleItem* item);
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+// the dependency graph of the previous run is kept next to the output files;
+// a compound file is regenerated only if the signature of its dependencies
+// (refids plus names and content hashes of source files) has changed since;
+// options affecting the output and the format/tool versions are mixed into
+// every signature, so changing any of them regenerates everything
+
+class DependencyGraph {
+protected:
+	enum {
+		FormatVersion = 2,
+	};
+
+	struct Entry {
+		uint64_t m_signature;
+		bool m_isVolatile;
+	};
+
+protected:
+	sl::String m_outputDir;
+	sl::String m_prevGraph; // previous entries reference it
+	sl::StringHashTable<Entry> m_prevEntryMap;
+	sl::StringHashTable<uint64_t> m_fileHashMap;
+	sl::Array<Variable*> m_compoundArray;
+	uint64_t m_optionHash;
+	size_t m_dirtyCount;
+
+public:
+	DependencyGraph();
+
+	size_t
+	getCompoundCount() {
+		return m_compoundArray.getCount();
+	}
+
+	size_t
+	getDirtyCount() {
+		return m_dirtyCount;
+	}
+
+	// must be called in the same order on every run (before adding compounds)
+
+	void
+	addOption(const sl::StringRef& option);
+
+	// a missing or outdated graph is not an error -- all compounds are dirty then
+
+	void
+	load(const sl::StringRef& outputDir);
+
+	void
+	addSourceFiles(Module* module);
+
+	// returns true if the compound file must be regenerated
+
+	bool
+	addCompound(Variable* compound);
+
+	// also removes files of compounds which are gone since the previous run
+
+	bool
+	save();
+
+protected:
+	sl::String
+	getFileName() {
+		return m_outputDir + "/.luadoxyxml-deps";
+	}
+
+	static
+	sl::String
+	getHeader();
+
+	uint64_t
+	calcSignature(CompoundDeps* deps);
+};
+
+//..............................................................................
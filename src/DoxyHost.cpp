@@ -12,7 +12,6 @@
 #include "pch.h"
 #include "DoxyHost.h"
 #include "Module.h"
-#include "Parser.llk.h"
 
 //..............................................................................
 
@@ -53,11 +52,7 @@ sl::StringRef
 DoxyHost::getItemCompoundElementName(handle_t item0) {
 	ModuleItem* item = (ModuleItem*)item0;
 
-	bool isCompoundFile =
-		item->m_itemKind == ModuleItemKind_Variable &&
-		((Variable*)item)->isLuaClass();
-
-	return isCompoundFile ? "innerclass" : NULL;
+	return item->isCompound() ? "innerclass" : NULL;
 };
 
 handle_t
@@ -65,12 +60,16 @@ DoxyHost::findItem(
 	const sl::StringRef& name,
 	size_t overloadIdx
 ) {
-	return m_module->findItem(name);
+	ModuleItem* item = m_module->findItem(name);
+	if (item)
+		item->m_isReferencedByName = true; // see DependencyGraph
+
+	return item;
 }
 
 handle_t
 DoxyHost::getCurrentNamespace() {
-	return (handle_t)(intptr_t)m_parser->getScopeLevel();
+	return (handle_t)(intptr_t)m_module->getCurrentScopeLevel();
 }
 
 bool
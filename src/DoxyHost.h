@@ -12,27 +12,21 @@
 #pragma once
 
 class Module;
-class Parser;
 
 //..............................................................................
 
 class DoxyHost: public dox::Host {
 protected:
 	Module* m_module;
-	Parser* m_parser;
 
 public:
 	DoxyHost() {
-		setup(NULL, NULL);
+		m_module = NULL;
 	}
 
 	void
-	setup(
-		Module* module,
-		Parser* parser
-	) {
+	setup(Module* module) {
 		m_module = module;
-		m_parser = parser;
 	}
 
 	virtual
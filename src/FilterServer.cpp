@@ -0,0 +1,414 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "FilterServer.h"
+#include "ParseMgr.h"
+
+#if (_AXL_OS_POSIX)
+#	include <sys/socket.h>
+#	include <sys/stat.h>
+#	include <sys/time.h>
+#	include <sys/un.h>
+#	include <unistd.h>
+#	include <signal.h>
+#	include <limits.h>
+#	include <stdlib.h>
+#	include <errno.h>
+#endif
+
+//..............................................................................
+
+#if (_AXL_OS_POSIX)
+
+static
+bool
+writeAll(
+	int socket,
+	const void* p,
+	size_t size
+) {
+	while (size) {
+		ssize_t result = ::write(socket, p, size);
+		if (result < 0) {
+			if (errno == EINTR)
+				continue;
+
+			err::setErrno(errno);
+			return false;
+		}
+
+		p = (char*)p + result;
+		size -= result;
+	}
+
+	return true;
+}
+
+static
+bool
+initUnixSocketAddress(
+	sockaddr_un* addr,
+	const sl::StringRef& socketPath
+) {
+	memset(addr, 0, sizeof(sockaddr_un));
+	addr->sun_family = AF_UNIX;
+
+	size_t length = socketPath.getLength();
+	if (length >= sizeof(addr->sun_path)) {
+		err::setFormatStringError("socket path too long: %s", socketPath.sz());
+		return false;
+	}
+
+	memcpy(addr->sun_path, socketPath.cp(), length);
+	return true;
+}
+
+#endif
+
+//..............................................................................
+
+FilterServer::FilterServer():
+	m_module(&m_doxyHost) {
+	m_doxyHost.setup(&m_module);
+	m_socket = -1;
+	m_sourceReader.m_isMappingDisabled = true; // a truncated mapped file would kill the server
+}
+
+bool
+FilterServer::filter(
+	OutputBuffer* output,
+	const sl::StringRef& fileName
+) {
+	m_module.clear();
+
+	Unit* unit = m_module.createUnit(fileName);
+
+	SourceReadRequest request;
+	request.m_fileName = fileName;
+	request.m_file = &unit->m_source;
+
+	SourceReadRequest* requestPtr = &request;
+	m_sourceReader.read(&requestPtr, 1);
+
+	if (!request.m_result) {
+		err::setError(request.m_error);
+		return false;
+	}
+
+	m_module.startDoxygenFilterOutput(output);
+
+	bool result = parseUnit(unit, &m_module);
+	if (!result)
+		return false;
+
+	m_module.bindUnit(unit);
+	m_module.bindPendingMethods(false);
+	m_module.finishDoxygenFilterOutput();
+	return true;
+}
+
+#if (_AXL_OS_POSIX)
+
+bool
+FilterServer::listen(const sl::StringRef& socketPath) {
+	close();
+
+	sockaddr_un addr;
+	bool result = initUnixSocketAddress(&addr, socketPath);
+	if (!result)
+		return false;
+
+	m_socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (m_socket == -1) {
+		err::setErrno(errno);
+		return false;
+	}
+
+	::unlink(addr.sun_path); // stale socket from a previous run
+
+	// the server reads any file it's asked to -- only the owner may connect
+	// (nobody can connect before listen, so there's no window)
+
+	if (::bind(m_socket, (sockaddr*)&addr, sizeof(addr)) != 0 ||
+		::chmod(addr.sun_path, 0600) != 0 ||
+		::listen(m_socket, SOMAXCONN) != 0) {
+		err::setErrno(errno);
+		close();
+		return false;
+	}
+
+	m_socketPath = socketPath;
+
+	// clients may go away before reading the reply
+
+	signal(SIGPIPE, SIG_IGN);
+	return true;
+}
+
+void
+FilterServer::close() {
+	if (m_socket == -1)
+		return;
+
+	::close(m_socket);
+	::unlink(m_socketPath.sz());
+	m_socket = -1;
+	m_socketPath.clear();
+}
+
+bool
+FilterServer::run() {
+	printf("Serving doxygen filter requests on %s...\n", m_socketPath.sz());
+
+	for (;;) {
+		int socket = ::accept(m_socket, NULL, NULL);
+		if (socket == -1) {
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+
+			err::setErrno(errno);
+			return false;
+		}
+
+		processRequest(socket);
+	}
+}
+
+void
+FilterServer::processRequest(int socket) {
+	timeval timeout;
+	timeout.tv_sec = ClientTimeout;
+	timeout.tv_usec = 0;
+
+	::setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	::setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+	sl::String fileName;
+	bool result = readRequest(socket, &fileName);
+
+	FILE* file = fdopen(socket, "w");
+	if (!file) {
+		::close(socket);
+		return;
+	}
+
+	OutputBuffer* output = new OutputBuffer(file);
+	output->setFramed(true);
+
+	if (result)
+		result = filter(output, fileName);
+
+	output->flush();
+	output->setFramed(false);
+
+	static const char emptyFrame[4] = { 0 }; // end of filter output
+	output->write(emptyFrame, sizeof(emptyFrame));
+
+	if (result)
+		output->format("%c", FilterReplyStatus_Success);
+	else
+		output->format("%c%s", FilterReplyStatus_Error, err::getLastErrorDescription().sz());
+
+	delete output; // flushes
+	fclose(file);
+}
+
+bool
+FilterServer::readRequest(
+	int socket,
+	sl::String* fileName
+) {
+	char buffer[1024];
+
+	fileName->clear();
+
+	for (;;) {
+		ssize_t size = ::read(socket, buffer, sizeof(buffer));
+		if (size < 0) {
+			if (errno == EINTR)
+				continue;
+
+			err::setErrno(errno);
+			return false;
+		}
+
+		if (!size)
+			break;
+
+		const char* end = (char*)memchr(buffer, '\n', size);
+		if (end) {
+			fileName->append(buffer, end - buffer);
+			return true;
+		}
+
+		fileName->append(buffer, size);
+		if (fileName->getLength() > MaxRequestSize)
+			break;
+	}
+
+	err::setFormatStringError("invalid doxygen filter request");
+	return false;
+}
+
+//..............................................................................
+
+bool
+FilterClient::connect(const sl::StringRef& socketPath) {
+	close();
+
+	sockaddr_un addr;
+	bool result = initUnixSocketAddress(&addr, socketPath);
+	if (!result)
+		return false;
+
+	m_socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (m_socket == -1) {
+		err::setErrno(errno);
+		return false;
+	}
+
+	if (::connect(m_socket, (sockaddr*)&addr, sizeof(addr)) != 0) {
+		err::setErrno(errno);
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+void
+FilterClient::close() {
+	if (m_socket == -1)
+		return;
+
+	::close(m_socket);
+	m_socket = -1;
+}
+
+bool
+FilterClient::filter(const sl::StringRef& fileName) {
+	char fullPath[PATH_MAX];
+	if (!realpath(fileName.sz(), fullPath)) {
+		err::setErrno(errno);
+		return false;
+	}
+
+	size_t length = strlen(fullPath);
+	fullPath[length++] = '\n';
+
+	bool result = writeAll(m_socket, fullPath, length);
+	if (!result)
+		return false;
+
+	::shutdown(m_socket, SHUT_WR);
+
+	char buffer[16 * 1024];
+	uchar_t header[4];
+	size_t headerSize = 0;
+	size_t frameSize = 0; // what's left of the current frame
+	sl::String reply;     // what follows the output
+	bool isOutputEnd = false;
+
+	for (;;) {
+		ssize_t size = ::read(m_socket, buffer, sizeof(buffer));
+		if (size < 0) {
+			if (errno == EINTR)
+				continue;
+
+			err::setErrno(errno);
+			return false;
+		}
+
+		if (!size)
+			break;
+
+		const char* p = buffer;
+		const char* end = buffer + size;
+		while (p < end) {
+			if (isOutputEnd) {
+				reply.append(p, end - p);
+				break;
+			}
+
+			if (frameSize) {
+				size_t chunkSize = AXL_MIN(frameSize, (size_t)(end - p));
+				fwrite(p, 1, chunkSize, stdout);
+				frameSize -= chunkSize;
+				p += chunkSize;
+				continue;
+			}
+
+			header[headerSize++] = *p++;
+			if (headerSize < sizeof(header))
+				continue;
+
+			frameSize =
+				((size_t)header[0] << 24) |
+				((size_t)header[1] << 16) |
+				((size_t)header[2] << 8) |
+				header[3];
+
+			headerSize = 0;
+			isOutputEnd = !frameSize;
+		}
+	}
+
+	if (reply.isEmpty()) {
+		err::setFormatStringError("doxygen filter server: incomplete reply");
+		return false;
+	}
+
+	if (reply[0] != FilterReplyStatus_Success) {
+		err::setFormatStringError("doxygen filter server: %s", reply.sz() + 1);
+		return false;
+	}
+
+	return true;
+}
+
+#else
+
+bool
+FilterServer::listen(const sl::StringRef& socketPath) {
+	err::setFormatStringError("doxygen filter server is not supported on this platform");
+	return false;
+}
+
+void
+FilterServer::close() {
+}
+
+bool
+FilterServer::run() {
+	return false;
+}
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+bool
+FilterClient::connect(const sl::StringRef& socketPath) {
+	err::setFormatStringError("doxygen filter server is not supported on this platform");
+	return false;
+}
+
+void
+FilterClient::close() {
+}
+
+bool
+FilterClient::filter(const sl::StringRef& fileName) {
+	return false;
+}
+
+#endif
+
+//..............................................................................
@@ -0,0 +1,115 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+#include "SourceFile.h"
+#include "OutputBuffer.h"
+#include "DoxyHost.h"
+#include "Module.h"
+
+//..............................................................................
+
+// Doxygen spawns a filter process per source file; with a long-running server,
+// each of these processes is a tiny client which forwards the absolute file
+// path over a Unix socket and relays the pseudo-C output back to Doxygen
+
+// protocol: the client sends "<path>\n"; the server streams the filter output
+// as frames (a 32-bit big-endian length followed by that many bytes), then an
+// empty frame and either '0' or '1' and the error description
+
+// requests are served one at a time; a client which stalls (doesn't send its
+// request or doesn't read the reply) is dropped after a timeout, so it can't
+// block other filter invocations for long
+
+enum FilterReplyStatus {
+	FilterReplyStatus_Success = '0',
+	FilterReplyStatus_Error   = '1',
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+class FilterServer {
+protected:
+	enum {
+		MaxRequestSize = 64 * 1024,
+		ClientTimeout  = 10, // sec
+	};
+
+protected:
+	int m_socket;
+	sl::String m_socketPath;
+	SourceReader m_sourceReader; // io_uring is reused between requests
+	DoxyHost m_doxyHost;
+	Module m_module; // cleared between requests, keeps its arena blocks
+
+public:
+	FilterServer();
+
+	~FilterServer() {
+		close();
+	}
+
+	bool
+	listen(const sl::StringRef& socketPath);
+
+	void
+	close();
+
+	bool
+	run();
+
+protected:
+	void
+	processRequest(int socket);
+
+	bool
+	filter(
+		OutputBuffer* output,
+		const sl::StringRef& fileName
+	);
+
+	static
+	bool
+	readRequest(
+		int socket,
+		sl::String* fileName
+	);
+};
+
+//..............................................................................
+
+class FilterClient {
+protected:
+	int m_socket;
+
+public:
+	FilterClient() {
+		m_socket = -1;
+	}
+
+	~FilterClient() {
+		close();
+	}
+
+	// fails if there's no server; the caller should filter in-process then
+
+	bool
+	connect(const sl::StringRef& socketPath);
+
+	void
+	close();
+
+	bool
+	filter(const sl::StringRef& fileName);
+};
+
+//..............................................................................
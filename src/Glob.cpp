@@ -0,0 +1,289 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "Glob.h"
+
+//..............................................................................
+
+bool
+Glob::compile(const sl::StringRef& pattern) {
+	m_pattern = pattern;
+	m_tokenArray.clear();
+	m_suffix.clear();
+
+	const char* p = pattern.cp();
+	const char* end = pattern.getEnd();
+
+	if (end - p >= 2 && p[0] == '.' && p[1] == '/')
+		p += 2;
+
+	m_isDirGlob = p < end && end[-1] == '/';
+	if (m_isDirGlob)
+		end--;
+
+	m_isPathGlob = memchr(p, '/', end - p) != NULL;
+
+	if (p >= end) {
+		err::setFormatStringError("invalid glob pattern '%s': empty", m_pattern.sz());
+		return false;
+	}
+
+	while (p < end) {
+		GlobToken token;
+		token.m_tokenKind = GlobTokenKind_Literal;
+		size_t length;
+
+		switch (*p) {
+		case '?':
+			token.m_tokenKind = GlobTokenKind_AnyChar;
+			p++;
+			break;
+
+		case '*':
+			if (p + 1 < end && p[1] == '*') {
+				if (p + 2 < end && p[2] == '/') {
+					token.m_tokenKind = GlobTokenKind_AnyDirPrefix;
+					p += 3;
+				} else {
+					token.m_tokenKind = GlobTokenKind_AnyPath;
+					p += 2;
+				}
+
+				m_isPathGlob = true;
+			} else {
+				token.m_tokenKind = GlobTokenKind_AnyString;
+				p++;
+			}
+
+			break;
+
+		case '[':
+			token.m_tokenKind = GlobTokenKind_CharSet;
+
+			length = parseCharSet(&token, p, end);
+			if (length == -1) {
+				err::setFormatStringError("invalid glob pattern '%s': unterminated '['", m_pattern.sz());
+				return false;
+			}
+
+			p += length;
+			break;
+
+		default:
+			// merge adjacent literal chars
+
+			while (p < end && *p != '?' && *p != '*' && *p != '[') {
+				if (*p == '\\' && p + 1 < end)
+					p++;
+
+				token.m_literal += *p++;
+			}
+		}
+
+		if (token.m_tokenKind == GlobTokenKind_Literal &&
+			!m_tokenArray.isEmpty() &&
+			m_tokenArray.getBack().m_tokenKind == GlobTokenKind_Literal)
+			m_tokenArray.getBack().m_literal += token.m_literal;
+		else
+			m_tokenArray.append(token);
+	}
+
+	size_t count = m_tokenArray.getCount();
+	if (m_tokenArray[count - 1].m_tokenKind == GlobTokenKind_Literal)
+		m_suffix = m_tokenArray[count - 1].m_literal;
+
+	m_isSuffixGlob =
+		count == 2 &&
+		m_tokenArray[0].m_tokenKind == GlobTokenKind_AnyString &&
+		m_tokenArray[1].m_tokenKind == GlobTokenKind_Literal &&
+		!m_isPathGlob;
+
+	return true;
+}
+
+size_t
+Glob::parseCharSet(
+	GlobToken* token,
+	const char* p0,
+	const char* end
+) {
+	memset(token->m_charSet, 0, sizeof(token->m_charSet));
+
+	const char* p = p0 + 1; // skip '['
+
+	bool isInverted = p < end && (*p == '!' || *p == '^');
+	if (isInverted)
+		p++;
+
+	bool isFirst = true;
+	for (;;) {
+		if (p >= end)
+			return -1;
+
+		if (*p == ']' && !isFirst)
+			break;
+
+		uchar_t from = *p++;
+		uchar_t to = from;
+
+		if (p + 1 < end && *p == '-' && p[1] != ']') {
+			to = p[1];
+			p += 2;
+		}
+
+		for (uint_t c = from; c <= to; c++)
+			token->m_charSet[c >> 5] |= 1 << (c & 31);
+
+		isFirst = false;
+	}
+
+	if (isInverted)
+		for (size_t i = 0; i < countof(token->m_charSet); i++)
+			token->m_charSet[i] = ~token->m_charSet[i];
+
+	token->m_charSet['/' >> 5] &= ~(1 << ('/' & 31));
+	return p + 1 - p0;
+}
+
+bool
+Glob::match(
+	const sl::StringRef& path,
+	const sl::StringRef& name,
+	bool isDir
+) const {
+	if (m_isDirGlob && !isDir)
+		return false;
+
+	const sl::StringRef& string = m_isPathGlob ? path : name;
+
+	size_t length = string.getLength();
+	size_t suffixLength = m_suffix.getLength();
+	if (suffixLength) {
+		if (length < suffixLength ||
+			memcmp(string.cp() + length - suffixLength, m_suffix.cp(), suffixLength) != 0)
+			return false;
+
+		if (m_isSuffixGlob) // names contain no slashes
+			return true;
+	}
+
+	return matchTokens(0, string.cp(), string.getEnd());
+}
+
+bool
+Glob::matchTokens(
+	size_t tokenIdx,
+	const char* p,
+	const char* end
+) const {
+	size_t count = m_tokenArray.getCount();
+	for (size_t i = tokenIdx; i < count; i++) {
+		const GlobToken& token = m_tokenArray[i];
+		size_t length;
+		uchar_t c;
+
+		switch (token.m_tokenKind) {
+		case GlobTokenKind_Literal:
+			length = token.m_literal.getLength();
+			if ((size_t)(end - p) < length || memcmp(p, token.m_literal.cp(), length) != 0)
+				return false;
+
+			p += length;
+			break;
+
+		case GlobTokenKind_AnyChar:
+			if (p >= end || *p == '/')
+				return false;
+
+			p++;
+			break;
+
+		case GlobTokenKind_CharSet:
+			if (p >= end)
+				return false;
+
+			c = *p;
+			if (!(token.m_charSet[c >> 5] & (1 << (c & 31))))
+				return false;
+
+			p++;
+			break;
+
+		case GlobTokenKind_AnyString:
+			if (i + 1 == count)
+				return memchr(p, '/', end - p) == NULL;
+
+			for (;; p++) {
+				if (matchTokens(i + 1, p, end))
+					return true;
+
+				if (p >= end || *p == '/')
+					return false;
+			}
+
+		case GlobTokenKind_AnyPath:
+			if (i + 1 == count)
+				return true;
+
+			for (; p <= end; p++)
+				if (matchTokens(i + 1, p, end))
+					return true;
+
+			return false;
+
+		case GlobTokenKind_AnyDirPrefix:
+			for (;;) {
+				if (matchTokens(i + 1, p, end))
+					return true;
+
+				p = (const char*)memchr(p, '/', end - p);
+				if (!p)
+					return false;
+
+				p++;
+			}
+		}
+	}
+
+	return p == end;
+}
+
+//..............................................................................
+
+bool
+GlobSet::add(const sl::StringRef& pattern) {
+	Glob* glob = new Glob;
+	bool result = glob->compile(pattern);
+	if (!result) {
+		delete glob;
+		return false;
+	}
+
+	m_globList.insertTail(glob);
+	return true;
+}
+
+bool
+GlobSet::match(
+	const sl::StringRef& path,
+	const sl::StringRef& name,
+	bool isDir
+) const {
+	sl::Iterator<Glob> it = m_globList.getHead();
+	for (; it; it++)
+		if (it->match(path, name, isDir))
+			return true;
+
+	return false;
+}
+
+//..............................................................................
@@ -0,0 +1,110 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+//..............................................................................
+
+enum GlobTokenKind {
+	GlobTokenKind_Literal,
+	GlobTokenKind_AnyChar,      // ?
+	GlobTokenKind_AnyString,    // * (never matches '/')
+	GlobTokenKind_AnyPath,      // **
+	GlobTokenKind_AnyDirPrefix, // **/ (also matches empty prefix)
+	GlobTokenKind_CharSet,      // [abc], [a-z], [!abc]
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+struct GlobToken {
+	GlobTokenKind m_tokenKind;
+	sl::String m_literal;
+	uint32_t m_charSet[256 / 32];
+};
+
+//..............................................................................
+
+// patterns without a slash are matched against file names; otherwise, against
+// paths relative to the source directory; a trailing slash restricts the
+// pattern to directories
+
+class Glob: public sl::ListLink {
+protected:
+	sl::String m_pattern;
+	sl::Array<GlobToken> m_tokenArray;
+	sl::String m_suffix; // literal suffix any match must end with
+	bool m_isPathGlob;
+	bool m_isDirGlob;
+	bool m_isSuffixGlob; // *<literal> -- the suffix check is enough
+
+public:
+	Glob() {
+		m_isPathGlob = false;
+		m_isDirGlob = false;
+		m_isSuffixGlob = false;
+	}
+
+	const sl::String&
+	getPattern() const {
+		return m_pattern;
+	}
+
+	bool
+	compile(const sl::StringRef& pattern);
+
+	bool
+	match(
+		const sl::StringRef& path,
+		const sl::StringRef& name,
+		bool isDir
+	) const;
+
+protected:
+	bool
+	matchTokens(
+		size_t tokenIdx,
+		const char* p,
+		const char* end
+	) const;
+
+	static
+	size_t
+	parseCharSet(
+		GlobToken* token,
+		const char* p,
+		const char* end
+	);
+};
+
+//..............................................................................
+
+class GlobSet {
+protected:
+	sl::List<Glob> m_globList;
+
+public:
+	bool
+	isEmpty() const {
+		return m_globList.isEmpty();
+	}
+
+	bool
+	add(const sl::StringRef& pattern);
+
+	bool
+	match(
+		const sl::StringRef& path,
+		const sl::StringRef& name,
+		bool isDir
+	) const;
+};
+
+//..............................................................................
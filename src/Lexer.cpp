@@ -46,12 +46,40 @@ Lexer::createFpToken() {
 	return token;
 }
 
+Token*
+Lexer::createLongStringToken() {
+	ASSERT(ts[0] == '[' && te[-1] == ']');
+
+	size_t level = 0;
+	while (ts[1 + level] == '=')
+		level++;
+
+	ASSERT(ts[1 + level] == '[' && te - ts >= (level + 2) * 2);
+
+	size_t left = level + 2;
+	size_t right = level + 2;
+
+	// a newline (\n, \r, \r\n or \n\r) right after the opening bracket is skipped
+
+	char c = ts[left];
+	if (c == '\n' || c == '\r') {
+		left++;
+
+		char c2 = ts[left];
+		if ((c2 == '\n' || c2 == '\r') && c2 != c)
+			left++;
+	}
+
+	return createStringToken(TokenKind_String, left, right);
+}
+
 Token*
 Lexer::createDoxyCommentToken(int tokenKind) {
 	ASSERT(te - ts >= 3 && ts[0] == '-' && ts[1] == '-');
 
 	size_t left = 0;
 	size_t right = 0;
+	size_t level = 0;
 
 	switch (tokenKind) {
 	case TokenKind_DoxyComment_sl: // --!
@@ -59,11 +87,14 @@ Lexer::createDoxyCommentToken(int tokenKind) {
 		left = 3;
 		break;
 
-	case TokenKind_DoxyComment_ml: // --[[!
-		ASSERT(ts[2] == '[' && ts[3] == '[' && ts[4] == '!');
-		ASSERT(te[-1] == ']' && te[-2] == ']');
-		left = 5;
-		right = 2;
+	case TokenKind_DoxyComment_ml: // --[[! or --[==[!
+		ASSERT(ts[2] == '[');
+		while (ts[3 + level] == '=')
+			level++;
+
+		ASSERT(ts[3 + level] == '[' && ts[4 + level] == '!' && te[-1] == ']');
+		left = level + 5;
+		right = level + 2;
 		break;
 
 	default:
@@ -73,4 +104,26 @@ Lexer::createDoxyCommentToken(int tokenKind) {
 	return createStringToken(tokenKind, left, right);
 }
 
+void
+Lexer::skip(size_t length) {
+	size_t lastLineOffset;
+	size_t lineCount = m_scanFuncTable->m_countLines(te, length, &lastLineOffset);
+	if (lineCount) {
+		m_line += (int)lineCount - 1;
+		newLine(te + lastLineOffset);
+	}
+
+	te += length;
+}
+
+bool
+Lexer::skipLongBracket(size_t level) {
+	size_t offset = m_scanFuncTable->m_findLongBracketEnd(te, pe - te, level);
+	if (offset == -1)
+		return false;
+
+	skip(offset + level + 2); // include the closing bracket
+	return true;
+}
+
 //..............................................................................
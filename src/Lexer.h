@@ -11,6 +11,8 @@
 
 #pragma once
 
+#include "TextScan.h"
+
 //..............................................................................
 
 enum TokenKind {
@@ -126,6 +128,14 @@ typedef lex::RagelToken<TokenKind, TokenName, lex::StdTokenData> Token;
 class Lexer: public lex::RagelLexer<Lexer, Token> {
 	friend class lex::RagelLexer<Lexer, Token>;
 
+public:
+	const ScanFuncTable* m_scanFuncTable; // scalar scans are for benchmarking
+
+public:
+	Lexer() {
+		m_scanFuncTable = &g_vectorScanFuncTable;
+	}
+
 protected:
 	Token*
 	createStringToken(
@@ -143,9 +153,34 @@ protected:
 	Token*
 	createFpToken();
 
+	Token*
+	createLongStringToken();
+
 	Token*
 	createDoxyCommentToken(int tokenKind);
 
+	// fast paths: advance te over a whitespace run or a comment body with
+	// bulk scans (the DFA only sees token starts); lines are accounted for
+
+	void
+	skip(size_t length);
+
+	void
+	skipWhitespace() {
+		te = ts; // the first char may be a newline
+		skip(m_scanFuncTable->m_findWhitespaceEnd(ts, pe - ts));
+	}
+
+	void
+	skipLineComment() {
+		skip(m_scanFuncTable->m_findLineEnd(te, pe - te));
+	}
+
+	// te must point right after the opening long bracket
+
+	bool
+	skipLongBracket(size_t level);
+
 	// implemented in *.rl
 
 	void
@@ -43,7 +43,6 @@ hex    = [0-9a-fA-F];
 oct    = [0-7];
 bin    = [01];
 id     = [_a-zA-Z] [_a-zA-Z0-9]*;
-ws     = [ \t\r]+;
 nl     = '\n' @{ newLine(p + 1); };
 lc_nl  = '\\' '\r'? nl;
 esc    = '\\' [^\n];
@@ -98,18 +97,37 @@ dec+            { createIntegerToken (10); };
 dec+ ('.' dec*) | ([eE] [+\-]? dec+)
 				{ createFpToken (); };
 
-'--!' [^\n]*    { createDoxyCommentToken(TokenKind_DoxyComment_sl); };
-
-'--[[!' @(Comment, 2) (any | nl)* :>> ']]'
-				{ createDoxyCommentToken(TokenKind_DoxyComment_ml); };
-
-'--[[' @(Comment, 1) (any | nl)* :>> ']]'
-				;
-
-'--' [^\n]* @(Comment, 0)
-				;
-
-ws | nl ;
+# comment bodies, long strings and whitespace runs are skipped with bulk
+# scans (see TextScan.h) -- te is advanced past them and the DFA resumes
+# there; fexec must precede createToken (which may stop the lexer at p + 1).
+# the level of a long bracket is the number of '=' chars in it; unterminated
+# long comments are line comments
+
+'[' '='* '['    {
+					if (skipLongBracket(te - ts - 2)) {
+						fexec te;
+						createLongStringToken();
+					} else {
+						createErrorToken(ts[0]);
+					}
+				};
+
+'--!'           { skipLineComment(); fexec te; createDoxyCommentToken(TokenKind_DoxyComment_sl); };
+
+'--[' '='* '[!' {
+					if (skipLongBracket(te - ts - 5)) {
+						fexec te;
+						createDoxyCommentToken(TokenKind_DoxyComment_ml);
+					} else {
+						skipLineComment();
+						fexec te;
+					}
+				};
+
+'--[' '='* '['  { if (!skipLongBracket(te - ts - 4)) skipLineComment(); fexec te; };
+'--'            { skipLineComment(); fexec te; };
+
+[ \t\r\n]       { skipWhitespace(); fexec te; };
 print           { createToken(ts[0]); };
 any             { createErrorToken(ts[0]); };
 
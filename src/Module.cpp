@@ -36,31 +36,26 @@ void
 Value::clear() {
 	m_valueKind = ValueKind_Empty;
 	m_table = NULL;
-	m_source.clear();
+	m_span = SourceSpan();
 }
 
 void
 Value::setFirstToken(
-	const Token::Pos& pos,
+	const SourceSpan& span,
 	ValueKind valueKind
 ) {
 	ASSERT(m_valueKind == ValueKind_Empty);
 
-	m_firstTokenPos = pos;
-	m_lastTokenPos = pos;
+	m_span = span;
 	m_valueKind = valueKind;
-	m_source = sl::StringRef(pos.m_p, pos.m_length);
 }
 
 void
-Value::appendSource(const Token::Pos& pos) {
+Value::appendSource(const SourceSpan& span) {
 	ASSERT(m_valueKind != ValueKind_Empty);
-	ASSERT(!m_source.isEmpty());
+	ASSERT(!m_span.isEmpty());
 
-	const char* p = m_source.cp();
-	const char* end = pos.m_p + pos.m_length;
-	m_source = sl::StringRef(p, end - p);
-	m_lastTokenPos = pos;
+	m_span.m_length = span.getEnd() - m_span.m_offset;
 }
 
 //..............................................................................
@@ -80,28 +75,39 @@ Table::addField(Variable* field) {
 ModuleItem::ModuleItem() {
 	m_itemKind = ModuleItemKind_Undefined;
 	m_module = NULL;
+	m_unit = NULL;
 	m_table = NULL;
 	m_isLocal = false;
+	m_isDeclared = false;
+	m_offset = 0;
 	m_doxyBlock = NULL;
+	m_isReferencedByName = false;
 }
 
 void
-ModuleItem::printDoxygenFilterComment(const sl::StringRef& indent) {
+ModuleItem::printDoxygenFilterComment(
+	OutputBuffer* output,
+	const sl::StringRef& indent
+) {
 	if (m_doxyBlock)
-		printf("%s/*! %s */\n", indent.sz(), m_doxyBlock->getSource().getTrimmedString().sz());
+		output->format("%s/*! %s */\n", indent.sz(), m_doxyBlock->getSource().getTrimmedString().sz());
 }
 
 bool
-ModuleItem::generateCompoundMemberDocumentation(
-	const sl::StringRef& outputDir,
-	sl::String* memberXml,
-	sl::String* compoundXml,
-	sl::String* sectionXml,
-	sl::String* indexXml
-) {
+ModuleItem::isCompound() {
 	return
-		generateDocumentation(outputDir, memberXml, indexXml) &&
-		sectionXml->append(*memberXml) != -1;
+		m_itemKind == ModuleItemKind_Variable &&
+		((Variable*)this)->isLuaClass();
+}
+
+void
+ModuleItem::prepareDocumentation(CompoundGenerator* compoundGenerator) {
+	ensureDoxyBlock()->getRefId();
+}
+
+void
+ModuleItem::collectDependencies(CompoundDeps* deps) {
+	deps->addItem(this);
 }
 
 //..............................................................................
@@ -188,7 +194,7 @@ Variable::ensureVariableKind() {
 bool
 Variable::generateDocumentation(
 	const sl::StringRef& outputDir,
-	sl::String* itemXml,
+	XmlWriter* itemXml,
 	sl::String* indexXml
 ) {
 	VariableKind variableKind = getVariableKind();
@@ -207,63 +213,170 @@ Variable::generateDocumentation(
 	}
 }
 
-bool
-Variable::generateCompoundMemberDocumentation(
-	const sl::StringRef& outputDir,
-	sl::String* memberXml,
-	sl::String* compoundXml,
-	sl::String* sectionXml,
-	sl::String* indexXml
-) {
-	bool result = generateDocumentation(outputDir, memberXml, indexXml);
-	if (!result)
-		return false;
+void
+Variable::prepareDocumentation(CompoundGenerator* compoundGenerator) {
+	VariableKind variableKind = getVariableKind(); // refid prefix depends on kind
+	ensureDoxyBlock()->getRefId();
+
+	if (variableKind == VariableKind_Enum) {
+		size_t count = m_initializer.m_table->m_fieldArray.getCount();
+		for (size_t i = 0; i < count; i++) {
+			Variable* field = m_initializer.m_table->m_fieldArray[i];
+			if (!field->m_initializer.isEmpty())
+				field->ensureDoxyBlock()->getRefId();
+		}
+	} else if (variableKind >= VariableKind_Class) {
+		compoundGenerator->addCompound(this);
+		prepareLuaBaseTypeDocumentation();
+
+		Table* table = m_initializer.m_table;
+		table->m_memberIndex.clear();
+
+		size_t count = table->m_fieldArray.getCount();
+		for (size_t i = 0; i < count; i++) {
+			Variable* field = table->m_fieldArray[i];
+			if (field->m_name.isEmpty())
+				continue;
+
+			if (field->m_initializer.m_valueKind != ValueKind_Function) {
+				field->prepareDocumentation(compoundGenerator);
+				table->m_memberIndex.add(field, field->isLuaClass() ? MemberKind_Compound : MemberKind_Item);
+				continue;
+			}
 
-	if (!isLuaClass()) {
-		sectionXml->append(*memberXml);
-		return true;
+			Function* function = field->m_initializer.m_function;
+			if (function->m_name.isEmpty()) {
+				function->m_name = field->m_name;
+				function->m_table = table;
+			}
+
+			function->prepareDocumentation(compoundGenerator);
+			table->m_memberIndex.add(function, MemberKind_Item);
+		}
+	}
+}
+
+void
+Variable::collectDependencies(CompoundDeps* deps) {
+	deps->addItem(this);
+
+	if (getVariableKind() != VariableKind_Enum)
+		return;
+
+	size_t count = m_initializer.m_table->m_fieldArray.getCount();
+	for (size_t i = 0; i < count; i++) {
+		Variable* field = m_initializer.m_table->m_fieldArray[i];
+		if (!field->m_initializer.isEmpty())
+			deps->addItem(field);
 	}
+}
 
-	static const char compoundFileHdr[] =
-		"<?xml version='1.0' encoding='UTF-8' standalone='no'?>\n"
-		"<doxygen>\n";
+const char*
+Variable::getDoxyCompoundKind() {
+	switch (getVariableKind()) {
+	case VariableKind_Module:
+		return "namespace";
 
-	static const char compoundFileTerm[] = "</doxygen>\n";
+	case VariableKind_Struct:
+		return "struct";
 
-	sl::String refId = ensureDoxyBlock()->getRefId();
-	sl::String fileName = sl::String(outputDir) + "/" + refId + ".xml";
+	default:
+		return "class";
+	}
+}
 
-	io::File compoundFile;
-	result =
-		compoundFile.open(fileName, io::FileFlag_Clear) &&
-		compoundFile.write(compoundFileHdr, lengthof(compoundFileHdr)) != -1 &&
-		compoundFile.write(*memberXml, memberXml->getLength()) != -1 &&
-		compoundFile.write(compoundFileTerm, lengthof(compoundFileTerm)) != -1;
+void
+Variable::collectCompoundDependencies(CompoundDeps* deps) {
+	ASSERT(isLuaClass());
+
+	deps->addItem(this);
+
+	sl::BoxList<sl::String> baseTypeNameList;
+	buildLuaBaseTypeNameList(&baseTypeNameList);
 
+	sl::BoxIterator<sl::String> it = baseTypeNameList.getHead();
+	for (; it; it++) {
+		ModuleItem* baseType = findBaseType(*it);
+		if (baseType)
+			deps->addItem(baseType);
+	}
+
+	// nested compounds are only referenced by refids; methods may come from
+	// other files
+
+	const MemberWalkIndex& memberIndex = m_initializer.m_table->m_memberIndex;
+	size_t count = memberIndex.getCount();
+	for (size_t i = 0; i < count; i++) {
+		ModuleItem* item = memberIndex.m_itemArray[i];
+		if (memberIndex.m_kindArray[i] == MemberKind_Compound)
+			deps->addItem(item);
+		else
+			item->collectDependencies(deps);
+	}
+}
+
+void
+Variable::generateIndexEntry(sl::String* indexXml) {
+	indexXml->appendFormat(
+		"<compound kind='%s' refid='%s'><name>%s</name></compound>\n",
+		getDoxyCompoundKind(),
+		m_doxyBlock->getRefId().sz(),
+		m_name.sz()
+	);
+}
+
+static const char compoundFileHdr[] =
+	"<?xml version='1.0' encoding='UTF-8' standalone='no'?>\n"
+	"<doxygen>\n";
+
+static const char compoundFileTerm[] = "</doxygen>\n";
+
+// the global compound is streamed here, then moved over global.xml once
+// dox::Module is done (see Module::generateDocumentation)
+
+static const char globalCompoundTempFileName[] = ".luadoxyxml-global.xml";
+
+bool
+Variable::generateCompoundFile(const sl::StringRef& outputDir) {
+	ASSERT(isLuaClass());
+
+	sl::String fileName = sl::String(outputDir) + "/" + ensureDoxyBlock()->getRefId() + ".xml";
+
+	XmlWriter compoundXml;
+	bool result = compoundXml.open(fileName);
 	if (!result)
 		return false;
 
-	compoundXml->appendFormat("<innerclass refid='%s'/>\n", refId.sz());
-	return true;
+	compoundXml.write(compoundFileHdr, lengthof(compoundFileHdr));
+
+	result = generateLuaClassDocumentation(outputDir, &compoundXml, NULL); // index entries are generated separately
+	if (!result)
+		return false;
+
+	compoundXml.write(compoundFileTerm, lengthof(compoundFileTerm));
+	return compoundXml.close();
 }
 
 void
-Variable::generateDoxygenFilterOutput(const sl::StringRef& indent) {
-	printDoxygenFilterComment();
+Variable::generateDoxygenFilterOutput(
+	OutputBuffer* output,
+	const sl::StringRef& indent
+) {
+	printDoxygenFilterComment(output);
 
 	VariableKind variableKind = getVariableKind();
 
 	switch (variableKind) {
 	case VariableKind_Enum:
-			return generateLuaEnumDoxygenFilterOutput(indent);
+			return generateLuaEnumDoxygenFilterOutput(output, indent);
 
 	case VariableKind_Class:
 	case VariableKind_Struct:
 	case VariableKind_Module:
-		return generateLuaClassDoxygenFilterOutput(indent);
+		return generateLuaClassDoxygenFilterOutput(output, indent);
 
 	default:
-		return generateVariableDoxygenFilterOutput(indent);
+		return generateVariableDoxygenFilterOutput(output, indent);
 	}
 }
 
@@ -295,7 +408,7 @@ Variable::buildLuaBaseTypeNameList(sl::BoxList<sl::String>* list) {
 bool
 Variable::generateVariableDocumentation(
 	const sl::StringRef& outputDir,
-	sl::String* itemXml,
+	XmlWriter* itemXml,
 	sl::String* indexXml
 ) {
 	ensureDoxyBlock();
@@ -306,21 +419,36 @@ Variable::generateVariableDocumentation(
 		m_isLocal ? " static='yes'" : ""
 	);
 
-	itemXml->appendFormat("<name>%s</name>\n", m_name.sz());
+	itemXml->format("<name>%s</name>\n", m_name.sz());
 
-	if (!m_initializer.m_source.isEmpty())
-		itemXml->appendFormat("<initializer>= %s</initializer>\n", m_initializer.m_source.sz());
+	if (!m_initializer.m_span.isEmpty())
+		itemXml->format("<initializer>= %s</initializer>\n", getSource(m_initializer.m_span).sz());
 
-	itemXml->append(m_doxyBlock->getImportString());
-	itemXml->append(m_doxyBlock->getDescriptionString());
-	itemXml->append(getLocationString());
-	itemXml->append("</memberdef>\n");
+	itemXml->print(m_doxyBlock->getImportString());
+	itemXml->print(m_doxyBlock->getDescriptionString());
+	itemXml->print(getLocationString());
+	itemXml->print("</memberdef>\n");
 
 	return true;
 }
 
+void
+Variable::prepareLuaBaseTypeDocumentation() {
+	sl::BoxList<sl::String> baseTypeNameList;
+	buildLuaBaseTypeNameList(&baseTypeNameList);
+
+	sl::BoxIterator<sl::String> it = baseTypeNameList.getHead();
+	for (; it; it++) {
+		ModuleItem* baseType = findBaseType(*it);
+		if (baseType)
+			baseType->ensureDoxyBlock()->getRefId();
+		else
+			fprintf(stderr, "\\luabasetype %s not found\n", it->sz());
+	}
+}
+
 bool
-Variable::generateLuaBaseTypeDocumentation(sl::String* itemXml) {
+Variable::generateLuaBaseTypeDocumentation(XmlWriter* itemXml) {
 	sl::BoxList<sl::String> baseTypeNameList;
 	buildLuaBaseTypeNameList(&baseTypeNameList);
 
@@ -328,14 +456,12 @@ Variable::generateLuaBaseTypeDocumentation(sl::String* itemXml) {
 	for (; it; it++) {
 		const sl::String& baseTypeName = *it;
 		ModuleItem* baseType = findBaseType(baseTypeName);
-		if (!baseType) {
-			fprintf(stderr, "\\luabasetype %s not found\n", baseTypeName.sz());
+		if (!baseType) // reported in prepareLuaBaseTypeDocumentation
 			continue;
-		}
 
-		baseType->ensureDoxyBlock();
+		ASSERT(baseType->m_doxyBlock);
 
-		itemXml->appendFormat(
+		itemXml->format(
 			"<basecompoundref refid='%s'>%s</basecompoundref>\n",
 			baseType->m_doxyBlock->getRefId().sz(),
 			baseTypeName.sz()
@@ -348,81 +474,48 @@ Variable::generateLuaBaseTypeDocumentation(sl::String* itemXml) {
 bool
 Variable::generateLuaClassDocumentation(
 	const sl::StringRef& outputDir,
-	sl::String* itemXml,
+	XmlWriter* itemXml,
 	sl::String* indexXml
 ) {
 	ASSERT(m_initializer.m_table && m_doxyBlock);
 
-	VariableKind variableKind = getVariableKind();
-	const char* doxyCompoundKind;
-	switch (variableKind) {
-	case VariableKind_Module:
-		doxyCompoundKind = "namespace";
-		break;
-
-	case VariableKind_Struct:
-		doxyCompoundKind = "struct";
-		break;
-
-	default:
-		doxyCompoundKind = "class";
-		break;
-	}
-
-	indexXml->appendFormat(
-		"<compound kind='%s' refid='%s'><name>%s</name></compound>\n",
-		doxyCompoundKind,
-		m_doxyBlock->getRefId().sz(),
-		m_name.sz()
-	);
-
 	itemXml->format(
 		"<compounddef kind='%s' id='%s' language='Lua'>\n"
 		"<compoundname>%s</compoundname>\n",
-		doxyCompoundKind,
+		getDoxyCompoundKind(),
 		m_doxyBlock->getRefId().sz(),
 		m_name.sz()
 	);
 
 	generateLuaBaseTypeDocumentation(itemXml);
 
-	sl::String fieldXml;
-	sl::String sectionDef;
+	// nested compounds are generated separately
 
-	size_t count = m_initializer.m_table->m_fieldArray.getCount();
-	for (size_t i = 0; i < count; i++) {
-		Variable* field = m_initializer.m_table->m_fieldArray[i];
-		if (field->m_name.isEmpty())
-			continue;
+	const MemberWalkIndex& memberIndex = m_initializer.m_table->m_memberIndex;
+	size_t count = memberIndex.getCount();
+	for (size_t i = 0; i < count; i++)
+		if (memberIndex.m_kindArray[i] == MemberKind_Compound)
+			itemXml->format("<innerclass refid='%s'/>\n", memberIndex.m_itemArray[i]->m_doxyBlock->getRefId().sz());
 
-		if (field->m_initializer.m_valueKind != ValueKind_Function) {
-			field->generateCompoundMemberDocumentation(outputDir, &fieldXml, itemXml, &sectionDef, indexXml);
-		} else {
-			if (field->m_initializer.m_function->m_name.isEmpty()) {
-				field->m_initializer.m_function->m_name = field->m_name;
-				field->m_initializer.m_function->m_table = m_initializer.m_table;
-			}
+	itemXml->print("<sectiondef>\n");
 
-			field->m_initializer.m_function->generateDocumentation(outputDir, &fieldXml, indexXml);
-			sectionDef.append(fieldXml);
-		}
-	}
+	for (size_t i = 0; i < count; i++)
+		if (memberIndex.m_kindArray[i] == MemberKind_Item)
+			memberIndex.m_itemArray[i]->generateDocumentation(outputDir, itemXml, indexXml);
 
-	itemXml->append("<sectiondef>\n");
-	itemXml->append(sectionDef);
-	itemXml->append("</sectiondef>\n");
+	itemXml->print("</sectiondef>\n");
 
 	sl::String footnoteXml = m_doxyBlock->getFootnoteString();
 	if (!footnoteXml.isEmpty()) {
-		itemXml->append("<sectiondef>\n");
-		itemXml->append(footnoteXml);
-		itemXml->append("</sectiondef>\n");
+		itemXml->print("<sectiondef>\n");
+		itemXml->print(footnoteXml);
+		itemXml->print("</sectiondef>\n");
 	}
 
-	itemXml->append(m_doxyBlock->getImportString());
-	itemXml->append(m_doxyBlock->getDescriptionString());
-	itemXml->append(getLocationString());
-	itemXml->append("</compounddef>\n");
+	itemXml->print(m_doxyBlock->getImportString());
+	itemXml->print(m_doxyBlock->getDescriptionString());
+	itemXml->print(getLocationString());
+	itemXml->print("</compounddef>\n");
 
 	return true;
 }
@@ -430,7 +523,7 @@ Variable::generateLuaClassDocumentation(
 bool
 Variable::generateLuaEnumDocumentation(
 	const sl::StringRef& outputDir,
-	sl::String* itemXml,
+	XmlWriter* itemXml,
 	sl::String* indexXml
 ) {
 	ASSERT(m_initializer.m_table && m_doxyBlock);
@@ -442,7 +535,6 @@ Variable::generateLuaEnumDocumentation(
 		m_name.sz()
 	);
 
-	sl::String fieldXml;
 	size_t count = m_initializer.m_table->m_fieldArray.getCount();
 	for (size_t i = 0; i < count; i++) {
 		Variable* field = m_initializer.m_table->m_fieldArray[i];
@@ -451,29 +543,32 @@ Variable::generateLuaEnumDocumentation(
 
 		field->ensureDoxyBlock();
 
-		itemXml->appendFormat("<enumvalue id='%s'>\n", field->m_doxyBlock->getRefId ().sz());
-		itemXml->appendFormat("<name>%s_%d</name>\n", m_name.sz(), i);
-		itemXml->appendFormat("<initializer>= %s</initializer>\n", field->m_initializer.m_source.sz());
-		itemXml->append(field->m_doxyBlock->getDescriptionString());
-		itemXml->append(field->getLocationString());
-		itemXml->append("</enumvalue>\n");
+		itemXml->format("<enumvalue id='%s'>\n", field->m_doxyBlock->getRefId ().sz());
+		itemXml->format("<name>%s_%d</name>\n", m_name.sz(), i);
+		itemXml->format("<initializer>= %s</initializer>\n", field->getSource(field->m_initializer.m_span).sz());
+		itemXml->print(field->m_doxyBlock->getDescriptionString());
+		itemXml->print(field->getLocationString());
+		itemXml->print("</enumvalue>\n");
 	}
 
 	sl::String footnoteXml = m_doxyBlock->getFootnoteString();
 	if (!footnoteXml.isEmpty())
-		itemXml->append(footnoteXml);
+		itemXml->print(footnoteXml);
 
-	itemXml->append(m_doxyBlock->getImportString());
-	itemXml->append(m_doxyBlock->getDescriptionString());
-	itemXml->append(getLocationString());
-	itemXml->append("</memberdef>\n");
+	itemXml->print(m_doxyBlock->getImportString());
+	itemXml->print(m_doxyBlock->getDescriptionString());
+	itemXml->print(getLocationString());
+	itemXml->print("</memberdef>\n");
 
 	return true;
 }
 
 void
-Variable::generateVariableDoxygenFilterOutput(const sl::StringRef& indent) {
-	printf(
+Variable::generateVariableDoxygenFilterOutput(
+	OutputBuffer* output,
+	const sl::StringRef& indent
+) {
+	output->format(
 		"%s%sint %s",
 		indent.sz(),
 		m_isLocal ? "static " : "",
@@ -481,23 +576,29 @@ Variable::generateVariableDoxygenFilterOutput(const sl::StringRef& indent) {
 	);
 
 	if (m_itemKind != ModuleItemKind_FunctionParam)
-		printf(";\n");
+		output->print(";\n");
 }
 
 bool
-Variable::generateLuaBaseTypeDoxygenFilterOutput(const sl::StringRef& indent) {
+Variable::generateLuaBaseTypeDoxygenFilterOutput(
+	OutputBuffer* output,
+	const sl::StringRef& indent
+) {
 	sl::BoxList<sl::String> baseTypeNameList;
 	buildLuaBaseTypeNameList(&baseTypeNameList);
 
 	sl::BoxIterator<sl::String> it = baseTypeNameList.getHead();
 	for (size_t i = 0; it; it++, i++)
-		printf("%s\t%c %s\n", indent.sz(), i ? ',' : ':', it->sz());
+		output->format("%s\t%c %s\n", indent.sz(), i ? ',' : ':', it->sz());
 
 	return true;
 }
 
 void
-Variable::generateLuaClassDoxygenFilterOutput(const sl::StringRef& indent) {
+Variable::generateLuaClassDoxygenFilterOutput(
+	OutputBuffer* output,
+	const sl::StringRef& indent
+) {
 	ASSERT(m_initializer.m_table && m_doxyBlock);
 
 	VariableKind variableKind = getVariableKind();
@@ -516,9 +617,9 @@ Variable::generateLuaClassDoxygenFilterOutput(const sl::StringRef& indent) {
 		break;
 	}
 
-	printf("%s %s\n", cppKeyword, m_name.sz());
-	generateLuaBaseTypeDoxygenFilterOutput(indent);
-	printf("{\n");
+	output->format("%s %s\n", cppKeyword, m_name.sz());
+	generateLuaBaseTypeDoxygenFilterOutput(output, indent);
+	output->print("{\n");
 
 	size_t count = m_initializer.m_table->m_fieldArray.getCount();
 	for (size_t i = 0; i < count; i++) {
@@ -527,25 +628,28 @@ Variable::generateLuaClassDoxygenFilterOutput(const sl::StringRef& indent) {
 			continue;
 
 		if (field->m_initializer.m_valueKind != ValueKind_Function) {
-			field->generateDoxygenFilterOutput("\t");
+			field->generateDoxygenFilterOutput(output, "\t");
 		} else {
 			if (field->m_initializer.m_function->m_name.isEmpty()) {
 				field->m_initializer.m_function->m_name = field->m_name;
 				field->m_initializer.m_function->m_table = m_initializer.m_table;
 			}
 
-			field->m_initializer.m_function->generateDoxygenFilterOutput("\t");
+			field->m_initializer.m_function->generateDoxygenFilterOutput(output, "\t");
 		}
 	}
 
-	printf("};\n\n");
+	output->print("};\n\n");
 }
 
 void
-Variable::generateLuaEnumDoxygenFilterOutput(const sl::StringRef& indent) {
+Variable::generateLuaEnumDoxygenFilterOutput(
+	OutputBuffer* output,
+	const sl::StringRef& indent
+) {
 	ASSERT(m_initializer.m_table && m_doxyBlock);
 
-	printf("enum %s\n{\n", m_name.sz());
+	output->format("enum %s\n{\n", m_name.sz());
 
 	size_t count = m_initializer.m_table->m_fieldArray.getCount();
 	for (size_t i = 0; i < count; i++) {
@@ -553,11 +657,11 @@ Variable::generateLuaEnumDoxygenFilterOutput(const sl::StringRef& indent) {
 		if (field->m_initializer.isEmpty())
 			continue;
 
-		field->printDoxygenFilterComment("\t");
-		printf("\t%s_%d = %s,\n", m_name.sz(), i, field->m_initializer.m_source.sz());
+		field->printDoxygenFilterComment(output, "\t");
+		output->format("\t%s_%d = %s,\n", m_name.sz(), i, field->getSource(field->m_initializer.m_span).sz());
 	}
 
-	printf("};\n\n");
+	output->print("};\n\n");
 }
 
 //..............................................................................
@@ -580,7 +684,7 @@ Function::createDoxyRefId() {
 bool
 Function::generateDocumentation(
 	const sl::StringRef& outputDir,
-	sl::String* itemXml,
+	XmlWriter* itemXml,
 	sl::String* indexXml
 ) {
 	ensureDoxyBlock();
@@ -592,49 +696,52 @@ Function::generateDocumentation(
 		m_isMethod ? " virt='virtual'" : ""
 	);
 
-	itemXml->appendFormat("<name>%s</name>\n", m_name.sz());
+	itemXml->format("<name>%s</name>\n", m_name.sz());
 
 	size_t count = m_paramArray.m_array.getCount();
 	for (size_t i = 0; i < count; i++) {
 		Variable* arg = m_paramArray.m_array[i];
 
-		itemXml->appendFormat(
+		itemXml->format(
 			"<param>\n"
 			"<declname>%s</declname>\n",
 			arg->m_name.sz()
 		);
 
-		if (!arg->m_initializer.m_source.isEmpty())
-			itemXml->appendFormat(
+		if (!arg->m_initializer.m_span.isEmpty())
+			itemXml->format(
 				"<defval>%s</defval>\n",
-				arg->m_initializer.m_source.sz()
+				arg->getSource(arg->m_initializer.m_span).sz()
 			);
 
 		if (arg->m_doxyBlock)
-			itemXml->append(arg->m_doxyBlock->getDescriptionString());
+			itemXml->print(arg->m_doxyBlock->getDescriptionString());
 
-		itemXml->append("</param>\n");
+		itemXml->print("</param>\n");
 	}
 
 	if (m_paramArray.m_isVarArg)
-		itemXml->append(
+		itemXml->print(
 			"<param>\n"
 			"<type>...</type>\n"
 			"</param>\n"
 		);
 
-	itemXml->append(m_doxyBlock->getImportString());
-	itemXml->append(m_doxyBlock->getDescriptionString());
-	itemXml->append(getLocationString());
-	itemXml->append("</memberdef>\n");
+	itemXml->print(m_doxyBlock->getImportString());
+	itemXml->print(m_doxyBlock->getDescriptionString());
+	itemXml->print(getLocationString());
+	itemXml->print("</memberdef>\n");
 	return true;
 }
 
 void
-Function::generateDoxygenFilterOutput(const sl::StringRef& indent) {
-	printDoxygenFilterComment();
+Function::generateDoxygenFilterOutput(
+	OutputBuffer* output,
+	const sl::StringRef& indent
+) {
+	printDoxygenFilterComment(output);
 
-	printf(
+	output->format(
 		"%s%s%sint %s(",
 		indent.sz(),
 		m_isLocal ? "static " : "",
@@ -643,7 +750,7 @@ Function::generateDoxygenFilterOutput(const sl::StringRef& indent) {
 	);
 
 	if (m_paramArray.m_array.isEmpty()) {
-		printf(m_paramArray.m_isVarArg ? "...);\n" : ");\n");
+		output->print(m_paramArray.m_isVarArg ? "...);\n" : ");\n");
 		return;
 	}
 
@@ -653,33 +760,132 @@ Function::generateDoxygenFilterOutput(const sl::StringRef& indent) {
 
 	size_t count = m_paramArray.m_array.getCount();
 	for (size_t i = 0; i < count; i++) {
-		printf(i ? ",\n" : "\n");
-		m_paramArray.m_array[i]->generateDoxygenFilterOutput(paramIndent);
+		output->print(i ? ",\n" : "\n");
+		m_paramArray.m_array[i]->generateDoxygenFilterOutput(output, paramIndent);
 	}
 
 	if (m_paramArray.m_isVarArg)
-		printf(",\n%s...\n%s);\n", paramIndent.sz(), paramIndent.sz());
+		output->format(",\n%s...\n%s);\n", paramIndent.sz(), paramIndent.sz());
 	else
-		printf("\n%s);\n", paramIndent.sz());
+		output->format("\n%s);\n", paramIndent.sz());
 }
 
 //..............................................................................
 
+Unit::Unit(Module* module):
+	m_doxyParser(&module->m_doxyModule) {
+	m_module = module;
+	m_boundEventCount = 0;
+	m_tokenCount = 0;
+	m_skippedTokenCount = 0;
+}
+
+void
+Unit::clear(Arena* recycleArena) {
+	// no need to unlink or free anything -- just run the destructors
+
+	sl::Iterator<ModuleItem> itemIt = m_itemList.getHead();
+	while (itemIt) {
+		ModuleItem* item = *itemIt;
+		itemIt++;
+		item->~ModuleItem();
+	}
+
+	sl::Iterator<Table> tableIt = m_tableList.getHead();
+	while (tableIt) {
+		Table* table = *tableIt;
+		tableIt++;
+		table->~Table();
+	}
+
+	m_itemList.clear();
+	m_tableList.clear();
+	m_eventArray.clear();
+	m_boundEventCount = 0;
+	m_lineOffsetArray.clear();
+	m_tokenCount = 0;
+	m_skippedTokenCount = 0;
+
+	if (recycleArena)
+		recycleArena->recycle(&m_arena);
+	else
+		m_arena.clear();
+}
+
+void
+Unit::unbind() {
+	sl::Iterator<ModuleItem> itemIt = m_itemList.getHead();
+	for (; itemIt; itemIt++) {
+		ModuleItem* item = *itemIt;
+		item->m_doxyBlock = NULL;
+		item->m_isReferencedByName = false;
+
+		if (item->m_itemKind != ModuleItemKind_Function) {
+			((Variable*)item)->m_variableKind = VariableKind_Undefined; // depends on the doxy block
+		} else if (item->m_table) { // an anonymous function named after its field
+			item->m_name.clear();
+			item->m_table = NULL;
+		}
+	}
+
+	sl::Iterator<Table> tableIt = m_tableList.getHead();
+	for (; tableIt; tableIt++)
+		tableIt->m_memberIndex.clear();
+
+	m_boundEventCount = 0;
+
+	// blocks left pending in the doxy parser belong to the cleared doxy module
+
+	m_doxyParser.~Parser();
+	new (&m_doxyParser) dox::Parser(&m_module->m_doxyModule);
+}
+
+void
+Unit::buildLineTable() {
+	sl::StringRef source = m_source.getSource();
+	const char* begin = source.cp();
+	const char* end = source.getEnd();
+
+	m_lineOffsetArray.clear();
+	m_lineOffsetArray.append(0);
+
+	const char* p = begin;
+	while ((p = (const char*)memchr(p, '\n', end - p))) {
+		p++;
+		m_lineOffsetArray.append((uint32_t)(p - begin));
+	}
+}
+
+lex::LineCol
+Unit::getLineCol(uint32_t offset) const {
+	ASSERT(!m_lineOffsetArray.isEmpty());
+
+	const uint32_t* begin = m_lineOffsetArray.cp();
+	const uint32_t* end = begin + m_lineOffsetArray.getCount();
+	const uint32_t* it = std::upper_bound(begin, end, offset) - 1;
+
+	lex::LineCol pos;
+	pos.m_line = (int)(it - begin);
+	pos.m_col = (int)(offset - *it);
+	return pos;
+}
+
 Variable*
-Module::createVariable(
+Unit::createVariable(
 	const sl::StringRef& name,
 	ModuleItemKind itemKind
 ) {
-	Variable* variable = new Variable;
+	Variable* variable = m_arena.construct<Variable>();
 	variable->m_itemKind = itemKind;
-	variable->m_module = this;
+	variable->m_module = m_module;
+	variable->m_unit = this;
 	variable->m_name = name;
 	m_itemList.insertTail(variable);
 	return variable;
 }
 
 Variable*
-Module::createTableVariable(
+Unit::createTableVariable(
 	const sl::StringRef& name,
 	ModuleItemKind itemKind
 ) {
@@ -689,21 +895,24 @@ Module::createTableVariable(
 }
 
 Function*
-Module::createFunction(const sl::StringRef& name) {
-	Function* function = new Function;
-	function->m_module = this;
+Unit::createFunction(const sl::StringRef& name) {
+	Function* function = m_arena.construct<Function>();
+	function->m_module = m_module;
+	function->m_unit = this;
 	function->m_name = name;
 	m_itemList.insertTail(function);
 	return function;
 }
 
 Table*
-Module::createTable() {
-	Table* table = new Table;
+Unit::createTable() {
+	Table* table = m_arena.construct<Table>();
 	m_tableList.insertTail(table);
 	return table;
 }
 
+//..............................................................................
+
 Table*
 Module::findTable(const sl::StringRef& name) {
 	sl::StringHashTableIterator<ModuleItem*> it = m_itemMap.find(name);
@@ -727,6 +936,295 @@ Module::findTableField(
 	return field->m_initializer.m_table;
 }
 
+void
+Module::clear() {
+	removeBoundFields();
+
+	while (!m_unitList.isEmpty()) {
+		Unit* unit = m_unitList.removeHead();
+		unit->clear(&m_recycledArena);
+		delete unit;
+	}
+
+	m_itemMap.clear();
+	m_undocumentedItemMap.clear();
+	m_pendingGlobalItemArray.clear();
+	m_pendingMethodArray.clear();
+	m_currentScopeLevel = 0;
+	m_isBound = false;
+	m_doxygenFilterOutput = NULL;
+	m_doxygenFilterItemArray.clear();
+	m_doxygenFilterMethodCountMap.clear();
+	m_isDoxygenFilterMethodCountValid = false;
+	m_doxyModule.clear();
+}
+
+void
+Module::unbind() {
+	if (!m_isBound)
+		return;
+
+	removeBoundFields();
+
+	sl::Iterator<Unit> it = m_unitList.getHead();
+	for (; it; it++)
+		it->unbind();
+
+	m_itemMap.clear();
+	m_undocumentedItemMap.clear();
+	m_pendingGlobalItemArray.clear();
+	m_pendingMethodArray.clear();
+	m_currentScopeLevel = 0;
+	m_isBound = false;
+	m_doxygenFilterItemArray.clear();
+	m_doxyModule.clear();
+}
+
+Unit*
+Module::createUnit(const sl::StringRef& fileName) {
+	Unit* unit = new Unit(this);
+	unit->m_fileName = fileName;
+	unit->m_arena.recycle(&m_recycledArena); // all of them; usually, there's one unit
+	m_unitList.insertTail(unit);
+	return unit;
+}
+
+void
+Module::removeUnit(Unit* unit) {
+	unbind(); // other units may reference its items and tables
+
+	m_unitList.remove(unit);
+	unit->clear(&m_recycledArena);
+	delete unit;
+}
+
+void
+Module::bindUnit(Unit* unit) {
+	m_isBound = true;
+
+	if (m_doxygenFilterOutput && !unit->m_boundEventCount) // the first call for this unit
+		m_isDoxygenFilterMethodCountValid =
+			m_unitList.getCount() == 1 &&
+			countDoxygenFilterMethods(unit);
+
+	size_t count = unit->m_eventArray.getCount();
+	for (size_t i = unit->m_boundEventCount; i < count; i++) {
+		const UnitEvent& event = unit->m_eventArray[i];
+		ModuleItem* item = event.m_item;
+		m_currentScopeLevel = event.m_scopeLevel;
+
+		switch (event.m_eventKind) {
+		case UnitEventKind_DoxyComment:
+			unit->m_doxyParser.addComment(event.m_comment, event.m_pos, event.m_isSingleLine, item);
+			break;
+
+		case UnitEventKind_Declaration:
+			bindDeclaration(unit, item);
+			break;
+
+		case UnitEventKind_GlobalDeclaration:
+			bindDeclaration(unit, item);
+
+			if (!item->m_name.isEmpty())
+				bindGlobalItem(item);
+
+			break;
+
+		case UnitEventKind_MethodDeclaration:
+			bindDeclaration(unit, item);
+
+			if (m_doxygenFilterOutput) {
+				sl::StringHashTableIterator<size_t> it = m_doxygenFilterMethodCountMap.find(*((Function*)item)->m_tableNameList.getHead());
+				if (it && it->m_value)
+					it->m_value--;
+			}
+
+			if (!bindMethod(unit, (Function*)item)) { // parent table may be declared later
+				PendingMethod pendingMethod;
+				pendingMethod.m_unit = unit;
+				pendingMethod.m_function = (Function*)item;
+				m_pendingMethodArray.append(pendingMethod);
+			}
+
+			break;
+
+		case UnitEventKind_TopLevelStatement:
+			if (!m_pendingGlobalItemArray.isEmpty())
+				materializeGlobalItems();
+
+			if (m_doxygenFilterOutput)
+				flushDoxygenFilterItems();
+
+			break;
+
+		case UnitEventKind_DropDoxyComment:
+			unit->m_doxyParser.popBlock(); // nothing left to attach it to
+			break;
+		}
+	}
+
+	if (!m_pendingGlobalItemArray.isEmpty())
+		materializeGlobalItems();
+
+	unit->m_boundEventCount = count;
+	m_currentScopeLevel = 0;
+}
+
+void
+Module::bindDeclaration(
+	Unit* unit,
+	ModuleItem* item
+) {
+	dox::Block* block = unit->m_doxyParser.popBlock();
+	if (block) {
+		item->m_doxyBlock = block;
+		block->m_item = item;
+	}
+}
+
+// in documented-only mode, global items only get into the item map once their
+// statements are complete (trailing comments may still document them), and
+// undocumented items never do -- unless they are tables, which methods and
+// base types are looked up by. these are left unmaterialized: no doxy blocks
+// are created for them and they are never generated
+
+void
+Module::bindGlobalItem(ModuleItem* item) {
+	if (m_isDocumentedOnly) {
+		if (m_itemMap.find(item->m_name) || m_undocumentedItemMap.find(item->m_name))
+			return; // keep the original declaration
+
+		m_undocumentedItemMap[item->m_name] = item;
+		m_pendingGlobalItemArray.append(item);
+		return;
+	}
+
+	sl::StringHashTableIterator<ModuleItem*> it = m_itemMap.visit(item->m_name);
+	if (it->m_value) // keep the original declaration
+		return;
+
+	it->m_value = item;
+
+	if (m_doxygenFilterOutput)
+		m_doxygenFilterItemArray.append(item);
+}
+
+void
+Module::materializeGlobalItems() {
+	size_t count = m_pendingGlobalItemArray.getCount();
+	for (size_t i = 0; i < count; i++) {
+		ModuleItem* item = m_pendingGlobalItemArray[i];
+
+		bool isTable =
+			item->m_itemKind == ModuleItemKind_Variable &&
+			((Variable*)item)->m_initializer.m_valueKind == ValueKind_Table;
+
+		if (!isTable && !item->m_doxyBlock && !item->m_isReferencedByName)
+			continue;
+
+		m_undocumentedItemMap.erase(m_undocumentedItemMap.find(item->m_name));
+		m_itemMap[item->m_name] = item;
+	}
+
+	m_pendingGlobalItemArray.clear();
+}
+
+bool
+Module::bindMethod(
+	Unit* unit,
+	Function* function
+) {
+	sl::BoxIterator<sl::StringRef> it = function->m_tableNameList.getHead();
+	Table* table = findTable(*it);
+	for (it++; table && it; it++) {
+		if (table->m_isOpaque) // fields of data tables are not there -- unresolved
+			return false;
+
+		table = findTableField(table, *it);
+	}
+
+	if (!table)
+		return false;
+
+	Variable* field = m_bindArena.construct<Variable>();
+	field->m_itemKind = ModuleItemKind_Field;
+	field->m_module = this;
+	field->m_unit = unit;
+	field->m_name = function->m_name;
+	field->setInitializer(function);
+	table->addField(field);
+	m_boundFieldArray.append(field);
+	return true;
+}
+
+void
+Module::removeBoundFields() {
+	// each field of a method went to the end of its table, so these come off
+	// in the reverse order; a field map entry goes back to the last parsed
+	// (or earlier bound) field of the same name
+
+	size_t i = m_boundFieldArray.getCount();
+	while (i--) {
+		Variable* field = m_boundFieldArray[i];
+		Table* table = field->m_table;
+		size_t count = table->m_fieldArray.getCount() - 1;
+		ASSERT(table->m_fieldArray[count] == field);
+		table->m_fieldArray.setCount(count);
+
+		sl::StringHashTableIterator<Variable*> it = table->m_fieldMap.find(field->m_name);
+		if (it && it->m_value == field) {
+			while (count && table->m_fieldArray[count - 1]->m_name != field->m_name)
+				count--;
+
+			if (count)
+				it->m_value = table->m_fieldArray[count - 1];
+			else
+				table->m_fieldMap.erase(it);
+		}
+
+		field->~Variable();
+	}
+
+	m_boundFieldArray.clear();
+	m_bindArena.reset();
+}
+
+size_t
+Module::bindPendingMethods(bool isVerbose) {
+	size_t unresolvedCount = 0;
+
+	size_t count = m_pendingMethodArray.getCount();
+	for (size_t i = 0; i < count; i++) {
+		const PendingMethod& pendingMethod = m_pendingMethodArray[i];
+		Function* function = pendingMethod.m_function;
+
+		bool result = bindMethod(pendingMethod.m_unit, function);
+		if (result)
+			continue;
+
+		unresolvedCount++;
+
+		if (isVerbose) {
+			sl::String name;
+			sl::BoxIterator<sl::StringRef> it = function->m_tableNameList.getHead();
+			for (; it; it++)
+				name.appendFormat("%s.", it->sz());
+
+			fprintf(
+				stderr,
+				"%s(%d): parent table of %s%s not found\n",
+				function->getFileName().sz(),
+				function->getLineCol().m_line + 1,
+				name.sz(),
+				function->m_name.sz()
+			);
+		}
+	}
+
+	m_pendingMethodArray.clear();
+	return unresolvedCount;
+}
+
 bool
 Module::generateGlobalNamespaceDocumentation(
 	const sl::StringRef& outputDir,
@@ -735,43 +1233,249 @@ Module::generateGlobalNamespaceDocumentation(
 ) {
 	bool result;
 
-	dox::Host* host = m_doxyModule.getHost();
+	CompoundGenerator compoundGenerator;
+	MemberWalkIndex memberIndex;
+
+	sl::Array<ModuleItem*> itemArray;
+	collectGlobalItems(&itemArray);
+
+	size_t count = itemArray.getCount();
+	for (size_t i = 0; i < count; i++) {
+		ModuleItem* item = itemArray[i];
+		item->prepareDocumentation(&compoundGenerator);
+		memberIndex.add(item, item->isCompound() ? MemberKind_Compound : MemberKind_Item);
+
+		dox::Group* doxyGroup = item->m_doxyBlock->getGroup();
+		if (doxyGroup)
+			doxyGroup->addItem(item);
+	}
 
 	*indexXml = "<compound kind='file' refid='global'><name>global</name></compound>\n";
 
-	*globalXml =
+	if (m_dependencyGraph)
+		compoundGenerator.skipUpToDateCompounds(m_dependencyGraph);
+
+	result = compoundGenerator.generate(outputDir, indexXml, m_compoundThreadCount);
+	if (!result)
+		return false;
+
+	sl::String fileName = sl::String(outputDir) + "/" + globalCompoundTempFileName;
+
+	XmlWriter xml;
+	result = xml.open(fileName);
+	if (!result)
+		return false;
+
+	xml.write(compoundFileHdr, lengthof(compoundFileHdr));
+	xml.print(
 		"<compounddef kind='file' id='global' language='Lua'>\n"
-		"<compoundname>global</compoundname>\n";
+		"<compoundname>global</compoundname>\n"
+	);
 
-	sl::String itemXml;
-	sl::String sectionDef;
+	count = memberIndex.getCount();
+	for (size_t i = 0; i < count; i++)
+		if (memberIndex.m_kindArray[i] == MemberKind_Compound)
+			xml.format("<innerclass refid='%s'/>\n", memberIndex.m_itemArray[i]->m_doxyBlock->getRefId().sz());
 
-	sl::StringHashTableIterator<ModuleItem*> it = m_itemMap.getHead();
-	for (; it; it++) {
-		ModuleItem* item = it->m_value;
+	xml.print("<sectiondef>\n");
+
+	for (size_t i = 0; i < count; i++) {
+		if (memberIndex.m_kindArray[i] != MemberKind_Item)
+			continue;
 
-		result = item->generateCompoundMemberDocumentation(outputDir, &itemXml, globalXml, &sectionDef, indexXml);
-		if (!result)
+		result = memberIndex.m_itemArray[i]->generateDocumentation(outputDir, &xml, indexXml);
+		if (!result) {
+			xml.close();
+			remove(fileName.sz());
 			return false;
+		}
+	}
 
-		dox::Block* doxyBlock = item->ensureDoxyBlock();
-		dox::Group* doxyGroup = doxyBlock->getGroup();
-		if (doxyGroup)
-			doxyGroup->addItem(item);
+	xml.print("</sectiondef>\n");
+	xml.print("</compounddef>\n");
+	xml.write(compoundFileTerm, lengthof(compoundFileTerm));
+
+	globalXml->clear(); // dox::Module only gets the (small) index
+	return xml.close();
+}
+
+bool
+Module::generateDocumentation(
+	const sl::StringRef& outputDir,
+	const sl::StringRef& indexFileName
+) {
+	sl::String tempFileName = sl::String(outputDir) + "/" + globalCompoundTempFileName;
+	sl::String fileName = sl::String(outputDir) + "/global.xml";
+
+	bool result = m_doxyModule.generateDocumentation(outputDir, indexFileName);
+
+#if (_AXL_OS_WIN)
+	if (result)
+		remove(fileName.sz()); // rename doesn't replace on Windows
+#endif
+
+	if (!result || rename(tempFileName.sz(), fileName.sz()) != 0) {
+		remove(tempFileName.sz());
+
+		if (result)
+			err::setFormatStringError("error writing %s", fileName.sz());
+
+		return false;
 	}
 
-	globalXml->append("<sectiondef>\n");
-	globalXml->append(sectionDef);
-	globalXml->append("</sectiondef>\n");
-	globalXml->append("</compounddef>\n");
 	return true;
 }
 
+// in documented-only mode, undocumented tables left in the item map (as well
+// as undocumented items left out of it) are dropped before doxy blocks get
+// created for them -- unless they are referenced by name or are base types of
+// documented classes (members of documented compounds are always generated)
+
 void
-Module::generateDoxygenFilterOutput() {
+Module::collectGlobalItems(sl::Array<ModuleItem*>* itemArray) {
 	sl::StringHashTableIterator<ModuleItem*> it = m_itemMap.getHead();
-	for (; it; it++)
-		it->m_value->generateDoxygenFilterOutput();
+
+	if (!m_isDocumentedOnly) {
+		for (; it; it++)
+			itemArray->append(it->m_value);
+
+		return;
+	}
+
+	sl::SimpleHashTable<ModuleItem*, bool> keptItemSet;
+	sl::Array<Variable*> classArray; // base types are yet to be kept
+
+	sl::StringHashTable<ModuleItem*>* mapArray[] = { &m_itemMap, &m_undocumentedItemMap };
+
+	for (size_t i = 0; i < countof(mapArray); i++)
+		for (it = mapArray[i]->getHead(); it; it++) {
+			ModuleItem* item = it->m_value;
+			if (!item->m_doxyBlock && !item->m_isReferencedByName) // e.g. documented later via \fn
+				continue;
+
+			keptItemSet.visit(item)->m_value = true;
+			if (item->isCompound())
+				classArray.append((Variable*)item);
+		}
+
+	while (!classArray.isEmpty()) {
+		Variable* variable = classArray.getBackAndPop();
+
+		sl::BoxList<sl::String> baseTypeNameList;
+		variable->buildLuaBaseTypeNameList(&baseTypeNameList);
+
+		sl::BoxIterator<sl::String> baseIt = baseTypeNameList.getHead();
+		for (; baseIt; baseIt++) {
+			ModuleItem* baseType = variable->findBaseType(*baseIt);
+			if (!baseType || keptItemSet.find(baseType))
+				continue;
+
+			keptItemSet.visit(baseType)->m_value = true;
+			if (baseType->isCompound())
+				classArray.append((Variable*)baseType);
+		}
+	}
+
+	for (size_t i = 0; i < countof(mapArray); i++)
+		for (it = mapArray[i]->getHead(); it; it++)
+			if (keptItemSet.find(it->m_value))
+				itemArray->append(it->m_value);
+}
+
+// final items are written in the order of declaration; items which are not
+// final yet are held back (without holding back the items after them) and
+// written as soon as they become final, or at the end of the file
+
+void
+Module::flushDoxygenFilterItems() {
+	size_t count = m_doxygenFilterItemArray.getCount();
+	size_t heldCount = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		ModuleItem* item = m_doxygenFilterItemArray[i];
+		if (isDoxygenFilterItemFinal(item))
+			item->generateDoxygenFilterOutput(m_doxygenFilterOutput);
+		else
+			m_doxygenFilterItemArray[heldCount++] = item;
+	}
+
+	m_doxygenFilterItemArray.setCount(heldCount);
+}
+
+// only Lua classes and enums list their fields; once the statement is
+// complete, fields may only be added by methods (function A.b () or
+// function A:b ()) -- either ones declared later in the unit or pending ones
+// declared before the table
+
+bool
+Module::isDoxygenFilterItemFinal(ModuleItem* item) {
+	if (item->m_itemKind != ModuleItemKind_Variable ||
+		((Variable*)item)->getVariableKind() == VariableKind_Normal)
+		return true;
+
+	if (!m_isDoxygenFilterMethodCountValid ||
+		m_doxygenFilterMethodCountMap.findValue(item->m_name, 0))
+		return false;
+
+	size_t count = m_pendingMethodArray.getCount();
+	for (size_t i = 0; i < count; i++)
+		if (*m_pendingMethodArray[i].m_function->m_tableNameList.getHead() == item->m_name)
+			return false;
+
+	return true;
+}
+
+// counts method declarations in the unit by the first table name (including
+// ones in nested scopes which never get bound -- a count which is too high
+// only delays the output, while one which is too low would cut classes short)
+
+bool
+Module::countDoxygenFilterMethods(Unit* unit) {
+	m_doxygenFilterMethodCountMap.clear();
+
+	Lexer lexer;
+	lexer.create(unit->m_source.getSource());
+
+	for (;;) {
+		const Token* token = lexer.getToken();
+		int tokenKind = token->m_token;
+		if (tokenKind == TokenKind_Eof)
+			return true;
+
+		if (tokenKind == TokenKind_Error)
+			return false;
+
+		lexer.nextToken();
+		if (tokenKind != TokenKind_Function)
+			continue;
+
+		token = lexer.getToken();
+		if (token->m_token != TokenKind_Identifier)
+			continue;
+
+		sl::String name = token->m_data.m_string; // the token is gone after nextToken
+		lexer.nextToken();
+
+		token = lexer.getToken();
+		if (token->m_token == '.' || token->m_token == ':')
+			m_doxygenFilterMethodCountMap.visit(name)->m_value++;
+	}
+}
+
+void
+Module::finishDoxygenFilterOutput() {
+	if (!m_doxygenFilterOutput)
+		return;
+
+	size_t count = m_doxygenFilterItemArray.getCount();
+	for (size_t i = 0; i < count; i++)
+		m_doxygenFilterItemArray[i]->generateDoxygenFilterOutput(m_doxygenFilterOutput);
+
+	m_doxygenFilterItemArray.clear();
+	m_doxygenFilterMethodCountMap.clear();
+	m_isDoxygenFilterMethodCountValid = false;
+	m_doxygenFilterOutput->flush();
+	m_doxygenFilterOutput = NULL;
 }
 
 //..............................................................................
@@ -12,8 +12,15 @@
 #pragma once
 
 #include "Lexer.h"
+#include "Arena.h"
+#include "SourceFile.h"
+#include "OutputBuffer.h"
+#include "XmlWriter.h"
+#include "CompoundGenerator.h"
+#include "DependencyGraph.h"
 
 class Module;
+struct Unit;
 struct Table;
 struct Variable;
 struct Function;
@@ -31,11 +38,40 @@ enum ValueKind {
 
 // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
+// compact reference to a piece of the unit source; lines and cols are only
+// needed for a few items, so these are looked up in the line table of the
+// unit on demand (see Unit::getLineCol)
+
+struct SourceSpan {
+	uint32_t m_offset;
+	uint32_t m_length;
+
+	SourceSpan() {
+		m_offset = 0;
+		m_length = 0;
+	}
+
+	SourceSpan(const Token::Pos& pos) {
+		m_offset = (uint32_t)pos.m_offset;
+		m_length = (uint32_t)pos.m_length;
+	}
+
+	bool
+	isEmpty() const {
+		return m_length == 0;
+	}
+
+	uint32_t
+	getEnd() const {
+		return m_offset + m_length;
+	}
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
 struct Value {
-	Token::Pos m_firstTokenPos;
-	Token::Pos m_lastTokenPos;
+	SourceSpan m_span; // from the first to the last token
 	ValueKind m_valueKind;
-	sl::StringRef m_source;
 	Table* m_table;
 	Function* m_function;
 
@@ -53,21 +89,64 @@ struct Value {
 
 	void
 	setFirstToken(
-		const Token::Pos& pos,
+		const SourceSpan& span,
 		ValueKind valueKind = ValueKind_Expression
 	);
 
+	// extends the value up to the end of the span
+
 	void
 	appendSource(
-		const Token::Pos& pos,
+		const SourceSpan& span,
 		ValueKind valueKind
 	) {
-		appendSource(pos);
+		appendSource(span);
 		m_valueKind = valueKind;
 	}
 
 	void
-	appendSource(const Token::Pos& pos);
+	appendSource(const SourceSpan& span);
+};
+
+//..............................................................................
+
+enum MemberKind {
+	MemberKind_Item,     // a variable, an enum or a function
+	MemberKind_Compound, // a nested Lua class (gets a file of its own)
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+// members of the global namespace or a Lua class to be generated, in the order
+// of declaration; generation walks members several times (refs to compounds,
+// then sections, then dependencies), so kinds are resolved once in the serial
+// prepare pass and kept next to item pointers -- the walks skip members of
+// other kinds by their kind bytes. methods are stored as their functions
+// rather than fields. items themselves are not moved or re-laid out
+
+struct MemberWalkIndex {
+	sl::Array<uint8_t> m_kindArray;
+	sl::Array<ModuleItem*> m_itemArray;
+
+	size_t
+	getCount() const {
+		return m_itemArray.getCount();
+	}
+
+	void
+	clear() {
+		m_kindArray.clear();
+		m_itemArray.clear();
+	}
+
+	void
+	add(
+		ModuleItem* item,
+		MemberKind kind
+	) {
+		m_kindArray.append((uint8_t)kind);
+		m_itemArray.append(item);
+	}
 };
 
 //..............................................................................
@@ -76,9 +155,12 @@ struct Table: sl::ListLink {
 	Variable* m_lvalue;
 	sl::Array<Variable*> m_fieldArray;
 	sl::StringHashTable<Variable*> m_fieldMap;
+	MemberWalkIndex m_memberIndex; // for Lua classes; built in prepareDocumentation
+	bool m_isOpaque; // a data table; fields were skipped by the parser
 
 	Table() {
 		m_lvalue = NULL;
+		m_isOpaque = false;
 	}
 
 	Variable*
@@ -102,15 +184,21 @@ enum ModuleItemKind {
 
 // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
+// names are slices of the source and file names are shared through the
+// unit, so items don't own any strings (unlike refids, which live in doxy
+// blocks)
+
 struct ModuleItem: sl::ListLink {
 	ModuleItemKind m_itemKind;
 	Module* m_module;
+	Unit* m_unit;
 	Table* m_table;
 	bool m_isLocal;
+	bool m_isDeclared; // m_offset is set and the file name is known
 	sl::StringRef m_name;
-	sl::String m_fileName;
-	Token::Pos m_pos;
+	uint32_t m_offset;
 	dox::Block* m_doxyBlock;
+	bool m_isReferencedByName; // looked up via dox::Host::findItem
 
 	ModuleItem();
 
@@ -120,6 +208,11 @@ struct ModuleItem: sl::ListLink {
 	dox::Block*
 	ensureDoxyBlock();
 
+	// Lua classes get compound files of their own
+
+	bool
+	isCompound();
+
 	virtual
 	sl::String
 	createDoxyRefId() = 0;
@@ -128,35 +221,54 @@ struct ModuleItem: sl::ListLink {
 	bool
 	generateDocumentation(
 		const sl::StringRef& outputDir,
-		sl::String* itemXml,
+		XmlWriter* itemXml,
 		sl::String* indexXml
 	) = 0;
 
+	// assigns doxy blocks and refids (in the order of declarations) and
+	// collects compounds -- everything the parallel generation must not touch
+
 	virtual
-	bool
-	generateCompoundMemberDocumentation(
-		const sl::StringRef& outputDir,
-		sl::String* memberXml,
-		sl::String* compoundXml,
-		sl::String* sectionXml,
-		sl::String* indexXml
-	);
+	void
+	prepareDocumentation(CompoundGenerator* compoundGenerator);
+
+	// source files and refids the XML of a parent compound depends on
+
+	virtual
+	void
+	collectDependencies(CompoundDeps* deps);
 
 	virtual
 	void
-	generateDoxygenFilterOutput(const sl::StringRef& indent = "") = 0;
+	generateDoxygenFilterOutput(
+		OutputBuffer* output,
+		const sl::StringRef& indent = ""
+	) = 0;
+
+	sl::StringRef
+	getFileName();
+
+	lex::LineCol
+	getLineCol();
+
+	sl::StringRef
+	getSource(const SourceSpan& span);
 
 	sl::String
 	getLocationString() {
+		lex::LineCol pos = getLineCol();
 		return sl::formatString("<location file='%s' line='%d' col='%d'/>\n",
-			m_fileName.sz(),
-			m_pos.m_line + 1,
-			m_pos.m_col + 1
+			getFileName().sz(),
+			pos.m_line + 1,
+			pos.m_col + 1
 		);
 	}
 
 	void
-	printDoxygenFilterComment(const sl::StringRef& indent = "");
+	printDoxygenFilterComment(
+		OutputBuffer* output,
+		const sl::StringRef& indent = ""
+	);
 
 protected:
 	dox::Block*
@@ -204,27 +316,38 @@ struct Variable: ModuleItem {
 	bool
 	generateDocumentation(
 		const sl::StringRef& outputDir,
-		sl::String* itemXml,
+		XmlWriter* itemXml,
 		sl::String* indexXml
 	);
 
 	virtual
-	bool
-	generateCompoundMemberDocumentation(
-		const sl::StringRef& outputDir,
-		sl::String* memberXml,
-		sl::String* compoundXml,
-		sl::String* sectionXml,
-		sl::String* indexXml
-	);
+	void
+	prepareDocumentation(CompoundGenerator* compoundGenerator);
 
 	virtual
 	void
-	generateDoxygenFilterOutput(const sl::StringRef& indent);
+	collectDependencies(CompoundDeps* deps);
 
-protected:
-	VariableKind
-	ensureVariableKind();
+	// for Lua classes only
+
+	const char*
+	getDoxyCompoundKind();
+
+	void
+	collectCompoundDependencies(CompoundDeps* deps);
+
+	void
+	generateIndexEntry(sl::String* indexXml);
+
+	bool
+	generateCompoundFile(const sl::StringRef& outputDir);
+
+	virtual
+	void
+	generateDoxygenFilterOutput(
+		OutputBuffer* output,
+		const sl::StringRef& indent
+	);
 
 	ModuleItem*
 	findBaseType(const sl::StringRef& name);
@@ -232,41 +355,63 @@ protected:
 	size_t
 	buildLuaBaseTypeNameList(sl::BoxList<sl::String>* list);
 
+protected:
+	VariableKind
+	ensureVariableKind();
+
 	bool
 	generateVariableDocumentation(
 		const sl::StringRef& outputDir,
-		sl::String* itemXml,
+		XmlWriter* itemXml,
 		sl::String* indexXml
 	);
 
+	// refids of base types are assigned in the serial prepare pass (in the
+	// same order as when compounds were generated one after another)
+
+	void
+	prepareLuaBaseTypeDocumentation();
+
 	bool
-	generateLuaBaseTypeDocumentation(sl::String* itemXml);
+	generateLuaBaseTypeDocumentation(XmlWriter* itemXml);
 
 	bool
 	generateLuaClassDocumentation(
 		const sl::StringRef& outputDir,
-		sl::String* itemXml,
+		XmlWriter* itemXml,
 		sl::String* indexXml
 	);
 
 	bool
 	generateLuaEnumDocumentation(
 		const sl::StringRef& outputDir,
-		sl::String* itemXml,
+		XmlWriter* itemXml,
 		sl::String* indexXml
 	);
 
 	void
-	generateVariableDoxygenFilterOutput(const sl::StringRef& indent);
+	generateVariableDoxygenFilterOutput(
+		OutputBuffer* output,
+		const sl::StringRef& indent
+	);
 
 	bool
-	generateLuaBaseTypeDoxygenFilterOutput(const sl::StringRef& indent);
+	generateLuaBaseTypeDoxygenFilterOutput(
+		OutputBuffer* output,
+		const sl::StringRef& indent
+	);
 
 	void
-	generateLuaClassDoxygenFilterOutput(const sl::StringRef& indent);
+	generateLuaClassDoxygenFilterOutput(
+		OutputBuffer* output,
+		const sl::StringRef& indent
+	);
 
 	void
-	generateLuaEnumDoxygenFilterOutput(const sl::StringRef& indent);
+	generateLuaEnumDoxygenFilterOutput(
+		OutputBuffer* output,
+		const sl::StringRef& indent
+	);
 };
 
 //..............................................................................
@@ -296,6 +441,7 @@ struct FunctionParamArray {
 
 struct Function: ModuleItem {
 	FunctionParamArray m_paramArray;
+	sl::BoxList<sl::StringRef> m_tableNameList; // A.b in function A.b.c()
 	bool m_isMethod;
 
 	Function();
@@ -308,40 +454,101 @@ struct Function: ModuleItem {
 	bool
 	generateDocumentation(
 		const sl::StringRef& outputDir,
-		sl::String* itemXml,
+		XmlWriter* itemXml,
 		sl::String* indexXml
 	);
 
 	virtual
 	void
-	generateDoxygenFilterOutput(const sl::StringRef& indent);
+	generateDoxygenFilterOutput(
+		OutputBuffer* output,
+		const sl::StringRef& indent
+	);
 };
 
 //..............................................................................
 
-class Module {
-	friend class Parser;
+enum UnitEventKind {
+	UnitEventKind_DoxyComment,
+	UnitEventKind_Declaration,
+	UnitEventKind_GlobalDeclaration,
+	UnitEventKind_MethodDeclaration,
+	UnitEventKind_TopLevelStatement, // all the preceding statements are complete
+	UnitEventKind_DropDoxyComment,   // pending at the end of a skipped function body
+};
 
-protected:
-	sl::List<Table> m_tableList;
-	sl::List<ModuleItem> m_itemList;
-	sl::StringHashTable<ModuleItem*> m_itemMap;
-	sl::BoxList<sl::String> m_sourceList;
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-public:
-	dox::Module m_doxyModule;
+// parser records doxy-comments and declarations in the exact order they occur;
+// the log is then replayed in Module::bindUnit (so parsing doesn't touch any
+// state shared between source files and multiple units can be parsed at once)
+
+struct UnitEvent {
+	UnitEventKind m_eventKind;
+	int m_scopeLevel;
+	ModuleItem* m_item; // for doxy-comments, this is the last declared item
+	sl::StringRef m_comment;
+	lex::LineCol m_pos;
+	bool m_isSingleLine;
+
+	UnitEvent() {
+		m_eventKind = UnitEventKind_Declaration;
+		m_scopeLevel = 0;
+		m_item = NULL;
+		m_isSingleLine = false;
+	}
+};
 
-public:
-	Module(dox::Host* doxyHost):
-		m_doxyModule(doxyHost) {}
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-	dox::Host* getDoxyHost() {
-		return m_doxyModule.getHost();
+// module items and tables are allocated in the arena of their unit -- each
+// unit is parsed on a single thread, and they all die together anyway. binding
+// doesn't add anything to units (fields of methods are allocated by the
+// module), so a unit can be unbound and bound again (see Module::unbind)
+
+struct Unit: sl::ListLink {
+	Module* m_module;
+	sl::String m_fileName;
+	SourceFile m_source; // need to keep sources alive since we use StringRef's in module items
+	Arena m_arena;
+	sl::AuxList<Table> m_tableList;
+	sl::AuxList<ModuleItem> m_itemList;
+	sl::Array<UnitEvent> m_eventArray;
+	size_t m_boundEventCount;
+	sl::Array<uint32_t> m_lineOffsetArray; // offsets of line starts
+	dox::Parser m_doxyParser;
+	size_t m_tokenCount;        // handed to the parser (0 for cached units)
+	size_t m_skippedTokenCount; // in function bodies and data tables
+
+	Unit(Module* module);
+
+	~Unit() {
+		clear();
 	}
 
-	ModuleItem*
-	findItem(const sl::StringRef& name) {
-		return m_itemMap.findValue(name, NULL);
+	// destroys all items, tables and events; arena blocks are freed or, if
+	// recycleArena is not NULL, handed over to it for reuse
+
+	void
+	clear(Arena* recycleArena = NULL);
+
+	// drops doxy blocks and everything else assigned while binding; parse
+	// results (items, tables and events) are kept
+
+	void
+	unbind();
+
+	// must be called once the source is loaded
+
+	void
+	buildLineTable();
+
+	lex::LineCol
+	getLineCol(uint32_t offset) const;
+
+	sl::StringRef
+	getSource(const SourceSpan& span) const {
+		return sl::StringRef(m_source.getSource().cp() + span.m_offset, span.m_length);
 	}
 
 	Variable*
@@ -361,6 +568,92 @@ public:
 
 	Table*
 	createTable();
+};
+
+//..............................................................................
+
+class Module {
+protected:
+	struct PendingMethod {
+		Unit* m_unit;
+		Function* m_function;
+	};
+
+protected:
+	sl::List<Unit> m_unitList;
+	Arena m_recycledArena; // blocks of cleared units, handed to new units
+	sl::StringHashTable<ModuleItem*> m_itemMap;
+	sl::StringHashTable<ModuleItem*> m_undocumentedItemMap; // documented-only mode: left out of the item map
+	sl::Array<ModuleItem*> m_pendingGlobalItemArray;        // documented-only mode: declared in this statement
+	sl::Array<PendingMethod> m_pendingMethodArray;
+	Arena m_bindArena; // fields of methods
+	sl::Array<Variable*> m_boundFieldArray; // in the order of binding
+	int m_currentScopeLevel;
+	bool m_isBound;
+
+	OutputBuffer* m_doxygenFilterOutput;
+	sl::Array<ModuleItem*> m_doxygenFilterItemArray; // not written yet, in the order of declaration
+	sl::StringHashTable<size_t> m_doxygenFilterMethodCountMap; // not bound yet, by the first table name
+	bool m_isDoxygenFilterMethodCountValid; // single unit, lexed without errors
+
+public:
+	dox::Module m_doxyModule;
+	DependencyGraph* m_dependencyGraph; // optional
+	size_t m_compoundThreadCount;
+	bool m_isDocumentedOnly; // leave undocumented global items (except tables) out of the item map
+	bool m_isDataTableMode;  // skip fields of undocumented table constructors
+
+public:
+	Module(dox::Host* doxyHost):
+		m_doxyModule(doxyHost) {
+		m_currentScopeLevel = 0;
+		m_isBound = false;
+		m_doxygenFilterOutput = NULL;
+		m_isDoxygenFilterMethodCountValid = false;
+		m_dependencyGraph = NULL;
+		m_compoundThreadCount = 1;
+		m_isDocumentedOnly = false;
+		m_isDataTableMode = false;
+	}
+
+	dox::Host* getDoxyHost() {
+		return m_doxyModule.getHost();
+	}
+
+	~Module() {
+		removeBoundFields();
+	}
+
+	// drops all units, items and doxy blocks, so the module can be reused
+	// (e.g. by the filter server); arena blocks are kept for the next units
+
+	void
+	clear();
+
+	// drops all the binding state, but keeps units with their parse results,
+	// so these can be bound again (e.g. in watch mode, after some of the
+	// units are replaced)
+
+	void
+	unbind();
+
+	const sl::List<Unit>&
+	getUnitList() {
+		return m_unitList;
+	}
+
+	int
+	getCurrentScopeLevel() {
+		return m_currentScopeLevel; // scope level of the event being bound
+	}
+
+	// undocumented items may still be looked up by name (e.g. via \fn)
+
+	ModuleItem*
+	findItem(const sl::StringRef& name) {
+		ModuleItem* item = m_itemMap.findValue(name, NULL);
+		return item ? item : m_undocumentedItemMap.findValue(name, NULL);
+	}
 
 	Table*
 	findTable(const sl::StringRef& name);
@@ -371,10 +664,31 @@ public:
 		const sl::StringRef& name
 	);
 
+	Unit*
+	createUnit(const sl::StringRef& fileName);
+
+	// unbinds the module first
+
+	void
+	removeUnit(Unit* unit);
+
+	void
+	bindUnit(Unit* unit);
+
+	size_t
+	bindPendingMethods(bool isVerbose = true);
+
+	// generates the XML database; the global compound and Lua classes are
+	// streamed to their files, dox::Module writes the index and groups
+
 	bool
-	addSource(const sl::String& source) {
-		return m_sourceList.insertTail(source) != NULL;
-	}
+	generateDocumentation(
+		const sl::StringRef& outputDir,
+		const sl::StringRef& indexFileName
+	);
+
+	// called back by dox::Module; the global compound goes straight to a
+	// file, so globalXml is left empty (see generateDocumentation)
 
 	bool
 	generateGlobalNamespaceDocumentation(
@@ -383,12 +697,76 @@ public:
 		sl::String* indexXml
 	);
 
+	// doxygen filter output is generated while binding: global items are
+	// written out as soon as they are final -- most of them, once their
+	// top-level statements are complete; Lua classes and enums, once no more
+	// methods can be added to them (see flushDoxygenFilterItems)
+
+	void
+	startDoxygenFilterOutput(OutputBuffer* output) {
+		m_doxygenFilterOutput = output;
+	}
+
+	void
+	finishDoxygenFilterOutput();
+
+protected:
+	void
+	collectGlobalItems(sl::Array<ModuleItem*>* itemArray);
+
+	void
+	flushDoxygenFilterItems();
+
+	bool
+	isDoxygenFilterItemFinal(ModuleItem* item);
+
+	bool
+	countDoxygenFilterMethods(Unit* unit);
+
+	void
+	bindDeclaration(
+		Unit* unit,
+		ModuleItem* item
+	);
+
+	void
+	bindGlobalItem(ModuleItem* item);
+
 	void
-	generateDoxygenFilterOutput();
+	materializeGlobalItems();
+
+	bool
+	bindMethod(
+		Unit* unit,
+		Function* function
+	);
+
+	// takes fields of methods off their tables, restoring parsed fields
+
+	void
+	removeBoundFields();
 };
 
 //..............................................................................
 
+inline
+sl::StringRef
+ModuleItem::getFileName() {
+	return m_isDeclared ? sl::StringRef(m_unit->m_fileName) : sl::StringRef();
+}
+
+inline
+lex::LineCol
+ModuleItem::getLineCol() {
+	return m_unit->getLineCol(m_offset);
+}
+
+inline
+sl::StringRef
+ModuleItem::getSource(const SourceSpan& span) {
+	return m_unit->getSource(span);
+}
+
 inline
 dox::Block*
 ModuleItem::ensureDoxyBlock() {
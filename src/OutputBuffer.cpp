@@ -0,0 +1,126 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "OutputBuffer.h"
+
+//..............................................................................
+
+OutputBuffer::OutputBuffer(
+	FILE* file,
+	size_t capacity
+) {
+	m_file = file;
+	m_buffer = (char*)malloc(capacity);
+	m_size = 0;
+	m_capacity = capacity;
+	m_isFramed = false;
+}
+
+OutputBuffer::~OutputBuffer() {
+	flush();
+	free(m_buffer);
+}
+
+void
+OutputBuffer::write(
+	const void* p,
+	size_t size
+) {
+	if (m_size + size > m_capacity) {
+		flush();
+
+		if (size > m_capacity) { // too big to buffer
+			writeChunk(p, size);
+			return;
+		}
+	}
+
+	memcpy(m_buffer + m_size, p, size);
+	m_size += size;
+}
+
+void
+OutputBuffer::format(
+	const char* formatString,
+	...
+) {
+	va_list va;
+	va_start(va, formatString);
+	format_va(formatString, va);
+	va_end(va);
+}
+
+void
+OutputBuffer::format_va(
+	const char* formatString,
+	va_list va
+) {
+	// try formatting in-place first
+
+	va_list va2;
+	va_copy(va2, va);
+	size_t freeSize = m_capacity - m_size;
+	int length = vsnprintf(m_buffer + m_size, freeSize, formatString, va2);
+	va_end(va2);
+
+	if (length < 0)
+		return;
+
+	if ((size_t)length < freeSize) {
+		m_size += length;
+		return;
+	}
+
+	flush();
+
+	if ((size_t)length < m_capacity) {
+		m_size = vsnprintf(m_buffer, m_capacity, formatString, va);
+		return;
+	}
+
+	sl::String string;
+	string.format_va(formatString, va);
+	writeChunk(string.cp(), string.getLength());
+}
+
+bool
+OutputBuffer::flush() {
+	if (m_size) {
+		writeChunk(m_buffer, m_size);
+		m_size = 0;
+	}
+
+	return fflush(m_file) == 0;
+}
+
+void
+OutputBuffer::writeChunk(
+	const void* p,
+	size_t size
+) {
+	if (m_isFramed) {
+		ASSERT(size <= 0xffffffff);
+
+		uchar_t header[4] = {
+			(uchar_t)(size >> 24),
+			(uchar_t)(size >> 16),
+			(uchar_t)(size >> 8),
+			(uchar_t)size,
+		};
+
+		fwrite(header, 1, sizeof(header), m_file);
+	}
+
+	fwrite(p, 1, size, m_file);
+}
+
+//..............................................................................
@@ -0,0 +1,88 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+//..............................................................................
+
+// large user-space buffer in front of a FILE; output is only passed to the
+// FILE in big chunks -- when the buffer is full or on an explicit flush
+
+class OutputBuffer {
+public:
+	enum {
+		DefaultCapacity = 256 * 1024,
+	};
+
+protected:
+	FILE* m_file;
+	char* m_buffer;
+	size_t m_size;
+	size_t m_capacity;
+	bool m_isFramed;
+
+public:
+	OutputBuffer(
+		FILE* file,
+		size_t capacity = DefaultCapacity
+	);
+
+	~OutputBuffer();
+
+	FILE*
+	getFile() {
+		return m_file;
+	}
+
+	// when framed, each chunk passed to the FILE is prefixed with its length
+	// (32-bit, big-endian) -- e.g. for streaming over sockets; the buffer
+	// should be flushed before switching
+
+	void
+	setFramed(bool isFramed) {
+		m_isFramed = isFramed;
+	}
+
+	void
+	write(
+		const void* p,
+		size_t size
+	);
+
+	void
+	print(const sl::StringRef& string) {
+		write(string.cp(), string.getLength());
+	}
+
+	void
+	format(
+		const char* formatString,
+		...
+	);
+
+	void
+	format_va(
+		const char* formatString,
+		va_list va
+	);
+
+	bool
+	flush();
+
+protected:
+	void
+	writeChunk(
+		const void* p,
+		size_t size
+	);
+};
+
+//..............................................................................
@@ -0,0 +1,209 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "OutputSync.h"
+
+#if (_AXL_OS_POSIX)
+#	include <unistd.h>
+#	include <signal.h>
+#	include <errno.h>
+#else
+#	include <direct.h>
+#endif
+
+//..............................................................................
+
+static
+bool
+isProcessAlive(int processId) {
+#if (_AXL_OS_POSIX)
+	return kill(processId, 0) == 0 || errno == EPERM;
+#else
+	HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
+	if (!process)
+		return GetLastError() == ERROR_ACCESS_DENIED;
+
+	DWORD exitCode;
+	bool isAlive = GetExitCodeProcess(process, &exitCode) && exitCode == STILL_ACTIVE;
+	CloseHandle(process);
+	return isAlive;
+#endif
+}
+
+// the directory must be closed before it can be removed (on Windows), so
+// these enumerate in functions of their own
+
+static
+void
+removeDirFiles(const sl::StringRef& dir) {
+	io::FileEnumerator fileEnum;
+	bool result = fileEnum.openDir(dir);
+	if (!result)
+		return;
+
+	while (fileEnum.hasNextFile()) {
+		sl::String name = fileEnum.getNextFileName();
+		if (name != "." && name != "..")
+			remove((dir + "/" + name).sz());
+	}
+}
+
+static
+bool
+moveChangedFiles(
+	const sl::StringRef& stagingDir,
+	const sl::StringRef& outputDir,
+	OutputSyncStats* stats
+) {
+	io::FileEnumerator fileEnum;
+	bool result = fileEnum.openDir(stagingDir);
+	if (!result)
+		return false;
+
+	while (fileEnum.hasNextFile()) {
+		sl::String name = fileEnum.getNextFileName();
+		if (name == "." || name == "..")
+			continue;
+
+		sl::String stagedFileName = stagingDir + "/" + name;
+		sl::String fileName = outputDir + "/" + name;
+
+		if (isSameFileContents(stagedFileName, fileName)) {
+			remove(stagedFileName.sz());
+			stats->m_unchangedFileCount++;
+			continue;
+		}
+
+#if (_AXL_OS_WIN)
+		remove(fileName.sz()); // rename doesn't replace on Windows
+#endif
+
+		if (rename(stagedFileName.sz(), fileName.sz()) != 0) {
+			err::setFormatStringError("error writing %s", fileName.sz());
+			return false;
+		}
+
+		stats->m_writtenFileCount++;
+	}
+
+	return true;
+}
+
+// .luadoxyxml-<pid> directories of processes which are no longer running
+
+static
+void
+removeStaleStagingDirs(const sl::StringRef& outputDir) {
+	static const char prefix[] = ".luadoxyxml-";
+
+	io::FileEnumerator fileEnum;
+	bool result = fileEnum.openDir(outputDir);
+	if (!result)
+		return;
+
+	while (fileEnum.hasNextFile()) {
+		sl::String name = fileEnum.getNextFileName();
+		if (!name.isPrefix(prefix))
+			continue;
+
+		const char* p = name.sz() + lengthof(prefix);
+		char* end;
+		long processId = strtol(p, &end, 10);
+		if (end == p || *end || processId <= 0 || isProcessAlive(processId))
+			continue;
+
+		sl::String dir = outputDir + "/" + name;
+		if (io::isDir(dir))
+			removeStagingDir(dir);
+	}
+}
+
+sl::String
+createStagingDir(const sl::StringRef& outputDir) {
+#if (_AXL_OS_POSIX)
+	int processId = getpid();
+#else
+	int processId = GetCurrentProcessId();
+#endif
+
+	removeStaleStagingDirs(outputDir);
+
+	sl::String stagingDir = sl::formatString("%s/.luadoxyxml-%d", outputDir.sz(), processId);
+	bool result = io::ensureDirExists(stagingDir);
+	if (!result)
+		return sl::String();
+
+	return stagingDir;
+}
+
+void
+removeStagingDir(const sl::StringRef& stagingDir) {
+	removeDirFiles(stagingDir);
+
+#if (_AXL_OS_POSIX)
+	rmdir(stagingDir.sz());
+#else
+	_rmdir(stagingDir.sz());
+#endif
+}
+
+bool
+syncOutputDir(
+	const sl::StringRef& stagingDir,
+	const sl::StringRef& outputDir,
+	OutputSyncStats* stats
+) {
+	bool result = moveChangedFiles(stagingDir, outputDir, stats);
+	removeStagingDir(stagingDir);
+	return result;
+}
+
+bool
+isSameFileContents(
+	const sl::StringRef& fileName1,
+	const sl::StringRef& fileName2
+) {
+	FILE* file1 = fopen(fileName1.sz(), "rb");
+	FILE* file2 = fopen(fileName2.sz(), "rb");
+
+	bool result = file1 && file2;
+	if (result) {
+		// different sizes is the most common case of changed contents
+
+		fseek(file1, 0, SEEK_END);
+		fseek(file2, 0, SEEK_END);
+		result = ftell(file1) == ftell(file2);
+		fseek(file1, 0, SEEK_SET);
+		fseek(file2, 0, SEEK_SET);
+	}
+
+	char buffer1[16 * 1024];
+	char buffer2[16 * 1024];
+
+	while (result) {
+		size_t size1 = fread(buffer1, 1, sizeof(buffer1), file1);
+		size_t size2 = fread(buffer2, 1, sizeof(buffer2), file2);
+		result = size1 == size2 && memcmp(buffer1, buffer2, size1) == 0;
+		if (size1 < sizeof(buffer1))
+			break;
+	}
+
+	if (file1)
+		fclose(file1);
+
+	if (file2)
+		fclose(file2);
+
+	return result;
+}
+
+//..............................................................................
@@ -0,0 +1,61 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+//..............................................................................
+
+// in the write-if-changed mode, documentation is generated into a staging
+// directory inside the output directory first; then only the files that differ
+// from what's already there are moved over (a rename is atomic on the same
+// file system), so unchanged files keep their mtimes and downstream builds
+// (doxyrest, Sphinx) only redo the pages which actually changed
+
+struct OutputSyncStats {
+	size_t m_writtenFileCount;
+	size_t m_unchangedFileCount;
+
+	OutputSyncStats() {
+		m_writtenFileCount = 0;
+		m_unchangedFileCount = 0;
+	}
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+// staging directories are named after the process id; ones left behind by
+// processes which are gone (killed, crashed) are removed first
+
+sl::String
+createStagingDir(const sl::StringRef& outputDir);
+
+// deletes the staging directory along with whatever is left in it
+
+void
+removeStagingDir(const sl::StringRef& stagingDir);
+
+// moves changed files, deletes the rest along with the staging directory
+// (on errors, too)
+
+bool
+syncOutputDir(
+	const sl::StringRef& stagingDir,
+	const sl::StringRef& outputDir,
+	OutputSyncStats* stats
+);
+
+bool
+isSameFileContents(
+	const sl::StringRef& fileName1,
+	const sl::StringRef& fileName2
+);
+
+//..............................................................................
@@ -0,0 +1,712 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "ParseCache.h"
+#include "Module.h"
+#include "version.h"
+
+#include <errno.h>
+
+#if (_AXL_OS_POSIX)
+#	include <unistd.h>
+#endif
+
+//..............................................................................
+
+// pointers to items and tables are written as their indexes in the unit lists
+// plus one (0 is NULL); source references are written as offsets plus one
+
+class PtrIndex {
+protected:
+	struct Entry {
+		const void* m_p;
+		size_t m_index;
+
+		bool
+		operator < (const Entry& entry) const {
+			return m_p < entry.m_p;
+		}
+	};
+
+protected:
+	sl::Array<Entry> m_array;
+
+public:
+	void
+	add(const void* p) {
+		Entry entry;
+		entry.m_p = p;
+		entry.m_index = m_array.getCount();
+		m_array.append(entry);
+	}
+
+	void
+	sort() {
+		std::sort(m_array.p(), m_array.p() + m_array.getCount());
+	}
+
+	// returns -1 if not found
+
+	size_t
+	find(const void* p) const {
+		Entry key;
+		key.m_p = p;
+
+		const Entry* begin = m_array.cp();
+		const Entry* end = begin + m_array.getCount();
+		const Entry* it = std::lower_bound(begin, end, key);
+		return it < end && it->m_p == p ? it->m_index : -1;
+	}
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+class ParseCacheWriter {
+protected:
+	sl::StringRef m_source;
+	PtrIndex m_itemIndex;
+	PtrIndex m_tableIndex;
+	bool m_isValid;
+
+public:
+	sl::Array<char> m_buffer;
+
+public:
+	ParseCacheWriter(const sl::StringRef& source) {
+		m_source = source;
+		m_isValid = true;
+	}
+
+	bool
+	writeUnit(Unit* unit);
+
+	void
+	writeUint(uint64_t value) {
+		char buffer[10];
+		size_t size = 0;
+
+		for (; value >= 0x80; value >>= 7)
+			buffer[size++] = (char)(value | 0x80);
+
+		buffer[size++] = (char)value;
+		m_buffer.append(buffer, size);
+	}
+
+protected:
+	void
+	writeString(const sl::StringRef& string);
+
+	void
+	writeSpan(const SourceSpan& span);
+
+	void
+	writeValue(const Value& value);
+
+	void
+	writeItemRef(const ModuleItem* item);
+
+	void
+	writeTableRef(const Table* table);
+
+	void
+	writeSourceOffset(const char* p);
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+class ParseCacheReader {
+protected:
+	const char* m_p;
+	const char* m_end;
+	sl::StringRef m_source;
+	sl::Array<ModuleItem*> m_itemArray;
+	sl::Array<Table*> m_tableArray;
+	bool m_isValid;
+
+public:
+	ParseCacheReader(
+		const sl::ArrayRef<char>& buffer,
+		const sl::StringRef& source
+	) {
+		m_p = buffer.cp();
+		m_end = m_p + buffer.getCount();
+		m_source = source;
+		m_isValid = true;
+	}
+
+	bool
+	readUnit(Unit* unit);
+
+	uint64_t
+	readUint();
+
+protected:
+	sl::StringRef
+	readString();
+
+	void
+	readSpan(SourceSpan* span);
+
+	void
+	readValue(Value* value);
+
+	ModuleItem*
+	readItemRef();
+
+	Table*
+	readTableRef();
+
+	const char*
+	readSourceOffset();
+};
+
+//..............................................................................
+
+bool
+ParseCacheWriter::writeUnit(Unit* unit) {
+	sl::Iterator<ModuleItem> itemIt = unit->m_itemList.getHead();
+	for (; itemIt; itemIt++)
+		m_itemIndex.add(*itemIt);
+
+	sl::Iterator<Table> tableIt = unit->m_tableList.getHead();
+	for (; tableIt; tableIt++)
+		m_tableIndex.add(*tableIt);
+
+	m_itemIndex.sort();
+	m_tableIndex.sort();
+
+	// items and tables are created first as they refer to each other
+
+	writeUint(unit->m_itemList.getCount());
+	writeUint(unit->m_tableList.getCount());
+
+	for (itemIt = unit->m_itemList.getHead(); itemIt; itemIt++) {
+		writeUint(itemIt->m_itemKind);
+		writeString(itemIt->m_name);
+	}
+
+	for (tableIt = unit->m_tableList.getHead(); tableIt; tableIt++) {
+		size_t count = tableIt->m_fieldArray.getCount();
+		writeItemRef(tableIt->m_lvalue);
+		writeUint(tableIt->m_isOpaque);
+		writeUint(count);
+
+		for (size_t i = 0; i < count; i++)
+			writeItemRef(tableIt->m_fieldArray[i]);
+	}
+
+	for (itemIt = unit->m_itemList.getHead(); itemIt; itemIt++) {
+		ModuleItem* item = *itemIt;
+		writeTableRef(item->m_table);
+		writeUint(item->m_isLocal);
+		writeUint(item->m_isDeclared);
+		writeUint(item->m_offset);
+
+		if (item->m_itemKind != ModuleItemKind_Function) {
+			Variable* variable = (Variable*)item;
+			writeValue(variable->m_index);
+			writeValue(variable->m_initializer);
+			continue;
+		}
+
+		Function* function = (Function*)item;
+		size_t count = function->m_paramArray.m_array.getCount();
+		writeUint(count);
+
+		for (size_t i = 0; i < count; i++)
+			writeItemRef(function->m_paramArray.m_array[i]);
+
+		writeUint(function->m_paramArray.m_isVarArg);
+		writeUint(function->m_isMethod);
+		writeUint(function->m_tableNameList.getCount());
+
+		sl::BoxIterator<sl::StringRef> it = function->m_tableNameList.getHead();
+		for (; it; it++)
+			writeString(*it);
+	}
+
+	size_t count = unit->m_eventArray.getCount();
+	writeUint(count);
+
+	for (size_t i = 0; i < count; i++) {
+		const UnitEvent& event = unit->m_eventArray[i];
+		writeUint(event.m_eventKind);
+		writeUint((uint_t)event.m_scopeLevel);
+		writeItemRef(event.m_item);
+		writeString(event.m_comment);
+		writeUint(event.m_pos.m_line);
+		writeUint(event.m_pos.m_col);
+		writeUint(event.m_isSingleLine);
+	}
+
+	return m_isValid;
+}
+
+void
+ParseCacheWriter::writeString(const sl::StringRef& string) {
+	size_t length = string.getLength();
+	if (!length) {
+		writeUint(0);
+		return;
+	}
+
+	// module items only ever reference the source text
+
+	if (string.cp() < m_source.cp() || string.getEnd() > m_source.getEnd()) {
+		m_isValid = false;
+		return;
+	}
+
+	writeSourceOffset(string.cp());
+	writeUint(length);
+}
+
+void
+ParseCacheWriter::writeSpan(const SourceSpan& span) {
+	writeUint(span.m_offset);
+	writeUint(span.m_length);
+}
+
+void
+ParseCacheWriter::writeValue(const Value& value) {
+	writeUint(value.m_valueKind);
+	if (value.m_valueKind == ValueKind_Empty)
+		return;
+
+	writeSpan(value.m_span);
+	writeTableRef(value.m_table);
+	writeItemRef(value.m_function);
+}
+
+void
+ParseCacheWriter::writeItemRef(const ModuleItem* item) {
+	if (!item) {
+		writeUint(0);
+		return;
+	}
+
+	size_t index = m_itemIndex.find(item);
+	if (index == -1)
+		m_isValid = false;
+
+	writeUint(index + 1);
+}
+
+void
+ParseCacheWriter::writeTableRef(const Table* table) {
+	if (!table) {
+		writeUint(0);
+		return;
+	}
+
+	size_t index = m_tableIndex.find(table);
+	if (index == -1)
+		m_isValid = false;
+
+	writeUint(index + 1);
+}
+
+void
+ParseCacheWriter::writeSourceOffset(const char* p) {
+	writeUint(p - m_source.cp() + 1);
+}
+
+//..............................................................................
+
+bool
+ParseCacheReader::readUnit(Unit* unit) {
+	size_t itemCount = readUint();
+	size_t tableCount = readUint();
+
+	// sanity check: each item or table takes at least one byte
+
+	if (itemCount > (size_t)(m_end - m_p) || tableCount > (size_t)(m_end - m_p))
+		return false;
+
+	m_itemArray.setCount(itemCount);
+	m_tableArray.setCount(tableCount);
+
+	for (size_t i = 0; i < itemCount; i++) {
+		ModuleItemKind itemKind = (ModuleItemKind)readUint();
+		sl::StringRef name = readString();
+
+		switch (itemKind) {
+		case ModuleItemKind_Variable:
+		case ModuleItemKind_Field:
+		case ModuleItemKind_FunctionParam:
+			m_itemArray[i] = unit->createVariable(name, itemKind);
+			break;
+
+		case ModuleItemKind_Function:
+			m_itemArray[i] = unit->createFunction(name);
+			break;
+
+		default:
+			return false;
+		}
+	}
+
+	for (size_t i = 0; i < tableCount; i++)
+		m_tableArray[i] = unit->createTable();
+
+	for (size_t i = 0; i < tableCount && m_isValid; i++) {
+		Table* table = m_tableArray[i];
+		ModuleItem* lvalue = readItemRef();
+		if (lvalue && lvalue->m_itemKind == ModuleItemKind_Function)
+			return false;
+
+		table->m_lvalue = (Variable*)lvalue;
+		table->m_isOpaque = readUint() != 0;
+
+		size_t fieldCount = readUint();
+		for (size_t j = 0; j < fieldCount && m_isValid; j++) {
+			Variable* field = (Variable*)readItemRef();
+			if (!field || field->m_itemKind == ModuleItemKind_Function)
+				return false;
+
+			table->m_fieldArray.append(field);
+
+			if (!field->m_name.isEmpty())
+				table->m_fieldMap[field->m_name] = field;
+		}
+	}
+
+	for (size_t i = 0; i < itemCount && m_isValid; i++) {
+		ModuleItem* item = m_itemArray[i];
+		item->m_table = readTableRef();
+		item->m_isLocal = readUint() != 0;
+
+		item->m_isDeclared = readUint() != 0;
+		item->m_offset = (uint32_t)readUint();
+
+		if (item->m_offset > m_source.getLength())
+			return false;
+
+		if (item->m_itemKind != ModuleItemKind_Function) {
+			Variable* variable = (Variable*)item;
+			readValue(&variable->m_index);
+			readValue(&variable->m_initializer);
+			continue;
+		}
+
+		Function* function = (Function*)item;
+		size_t count = readUint();
+		for (size_t j = 0; j < count && m_isValid; j++) {
+			Variable* param = (Variable*)readItemRef();
+			if (!param || param->m_itemKind == ModuleItemKind_Function)
+				return false;
+
+			function->m_paramArray.m_array.append(param);
+		}
+
+		function->m_paramArray.m_isVarArg = readUint() != 0;
+		function->m_isMethod = readUint() != 0;
+
+		count = readUint();
+		for (size_t j = 0; j < count && m_isValid; j++)
+			function->m_tableNameList.insertTail(readString());
+	}
+
+	size_t eventCount = readUint();
+	if (eventCount > (size_t)(m_end - m_p))
+		return false;
+
+	unit->m_eventArray.setCount(eventCount);
+
+	for (size_t i = 0; i < eventCount && m_isValid; i++) {
+		UnitEvent* event = &unit->m_eventArray[i];
+		event->m_eventKind = (UnitEventKind)readUint();
+		event->m_scopeLevel = (int)readUint();
+		event->m_item = readItemRef();
+		event->m_comment = readString();
+		event->m_pos.m_line = (int)readUint();
+		event->m_pos.m_col = (int)readUint();
+		event->m_isSingleLine = readUint() != 0;
+
+		if (event->m_eventKind > UnitEventKind_DropDoxyComment ||
+			(event->m_eventKind != UnitEventKind_DoxyComment &&
+			event->m_eventKind != UnitEventKind_TopLevelStatement &&
+			event->m_eventKind != UnitEventKind_DropDoxyComment &&
+			!event->m_item))
+			return false;
+	}
+
+	return m_isValid && m_p == m_end;
+}
+
+uint64_t
+ParseCacheReader::readUint() {
+	uint64_t value = 0;
+
+	for (size_t shift = 0; shift < 64; shift += 7) {
+		if (m_p >= m_end)
+			break;
+
+		uchar_t c = *m_p++;
+		value |= (uint64_t)(c & 0x7f) << shift;
+		if (!(c & 0x80))
+			return value;
+	}
+
+	m_isValid = false;
+	return 0;
+}
+
+sl::StringRef
+ParseCacheReader::readString() {
+	const char* p = readSourceOffset();
+	if (!p)
+		return sl::StringRef();
+
+	size_t length = readUint();
+	if (length > (size_t)(m_source.getEnd() - p)) {
+		m_isValid = false;
+		return sl::StringRef();
+	}
+
+	return sl::StringRef(p, length);
+}
+
+void
+ParseCacheReader::readSpan(SourceSpan* span) {
+	span->m_offset = (uint32_t)readUint();
+	span->m_length = (uint32_t)readUint();
+
+	if ((uint64_t)span->m_offset + span->m_length > m_source.getLength())
+		m_isValid = false;
+}
+
+void
+ParseCacheReader::readValue(Value* value) {
+	value->m_valueKind = (ValueKind)readUint();
+	if (value->m_valueKind == ValueKind_Empty)
+		return;
+
+	if (value->m_valueKind > ValueKind_Table) {
+		m_isValid = false;
+		return;
+	}
+
+	readSpan(&value->m_span);
+	value->m_table = readTableRef();
+
+	ModuleItem* function = readItemRef();
+	if (function && function->m_itemKind != ModuleItemKind_Function)
+		m_isValid = false;
+	else
+		value->m_function = (Function*)function;
+}
+
+ModuleItem*
+ParseCacheReader::readItemRef() {
+	size_t index = readUint();
+	if (!index)
+		return NULL;
+
+	if (index > m_itemArray.getCount()) {
+		m_isValid = false;
+		return NULL;
+	}
+
+	return m_itemArray[index - 1];
+}
+
+Table*
+ParseCacheReader::readTableRef() {
+	size_t index = readUint();
+	if (!index)
+		return NULL;
+
+	if (index > m_tableArray.getCount()) {
+		m_isValid = false;
+		return NULL;
+	}
+
+	return m_tableArray[index - 1];
+}
+
+const char*
+ParseCacheReader::readSourceOffset() {
+	size_t offset = readUint();
+	if (!offset)
+		return NULL;
+
+	if (offset - 1 > m_source.getLength()) {
+		m_isValid = false;
+		return NULL;
+	}
+
+	return m_source.cp() + offset - 1;
+}
+
+//..............................................................................
+
+ParseCache::ParseCache() {
+	m_hitCount = 0;
+	m_missCount = 0;
+	m_tempFileCount = 0;
+}
+
+bool
+ParseCache::open(const sl::StringRef& dir) {
+	bool result = io::ensureDirExists(dir);
+	if (!result)
+		return false;
+
+	m_dir = dir;
+	return true;
+}
+
+uint64_t
+ParseCache::hashSource(const sl::StringRef& source) {
+	return fnv1aHash(source.cp(), source.getLength());
+}
+
+sl::String
+ParseCache::getFileName(uint64_t hash) {
+	return sl::formatString("%s/%016llx.ldxc", m_dir.sz(), (unsigned long long)hash);
+}
+
+bool
+ParseCache::loadFile(
+	uint64_t hash,
+	sl::Array<char>* buffer
+) {
+	sl::String fileName = getFileName(hash);
+	FILE* file = fopen(fileName.sz(), "rb");
+	if (!file)
+		return false;
+
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	if (size > 0) {
+		buffer->setCount(size);
+		if (fread(buffer->p(), 1, size, file) != (size_t)size)
+			buffer->clear();
+	}
+
+	fclose(file);
+	return !buffer->isEmpty();
+}
+
+bool
+ParseCache::load(
+	Unit* unit,
+	uint64_t hash
+) {
+	sl::Array<char> buffer;
+
+	loadFile(hash, &buffer);
+
+	sl::StringRef source = unit->m_source.getSource();
+	ParseCacheReader reader(buffer, source);
+
+	sl::StringRef version = VERSION_STRING;
+	bool result = !buffer.isEmpty();
+
+	if (result) {
+		result =
+			reader.readUint() == Signature &&
+			reader.readUint() == FormatVersion &&
+			reader.readUint() == version.getLength();
+
+		for (size_t i = 0; result && i < version.getLength(); i++)
+			result = reader.readUint() == (uchar_t)version[i];
+
+		result =
+			result &&
+			reader.readUint() == hash &&
+			reader.readUint() == source.getLength() &&
+			reader.readUnit(unit);
+	}
+
+	if (!result) {
+		unit->clear();
+		sys::atomicInc(&m_missCount);
+		return false;
+	}
+
+	unit->buildLineTable();
+	sys::atomicInc(&m_hitCount);
+	return true;
+}
+
+bool
+ParseCache::store(
+	Unit* unit,
+	uint64_t hash
+) {
+	sl::StringRef source = unit->m_source.getSource();
+	ParseCacheWriter writer(source);
+
+	sl::StringRef version = VERSION_STRING;
+
+	writer.writeUint(Signature);
+	writer.writeUint(FormatVersion);
+	writer.writeUint(version.getLength());
+
+	for (size_t i = 0; i < version.getLength(); i++)
+		writer.writeUint((uchar_t)version[i]);
+
+	writer.writeUint(hash);
+	writer.writeUint(source.getLength());
+
+	bool result = writer.writeUnit(unit);
+	if (!result) {
+		err::setFormatStringError("%s: can't be cached", unit->m_fileName.sz());
+		return false;
+	}
+
+	// write to a unique temp file first, so concurrent runs never see a
+	// partially written entry
+
+#if (_AXL_OS_POSIX)
+	int processId = getpid();
+#else
+	int processId = GetCurrentProcessId();
+#endif
+
+	sl::String fileName = getFileName(hash);
+	sl::String tempFileName = sl::formatString(
+		"%s.%d.%d.tmp",
+		fileName.sz(),
+		processId,
+		sys::atomicInc(&m_tempFileCount)
+	);
+
+	FILE* file = fopen(tempFileName.sz(), "wb");
+	if (!file) {
+		err::setErrno(errno);
+		return false;
+	}
+
+	size_t size = writer.m_buffer.getCount();
+	result = fwrite(writer.m_buffer.cp(), 1, size, file) == size;
+	result = fclose(file) == 0 && result;
+
+#if (_AXL_OS_WIN)
+	if (result)
+		remove(fileName.sz()); // rename doesn't replace on Windows
+#endif
+
+	if (!result || rename(tempFileName.sz(), fileName.sz()) != 0) {
+		err::setFormatStringError("error writing %s", fileName.sz());
+		remove(tempFileName.sz());
+		return false;
+	}
+
+	return true;
+}
+
+//..............................................................................
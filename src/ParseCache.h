@@ -0,0 +1,96 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+struct Unit;
+
+//..............................................................................
+
+// parsing depends on nothing but the source text, so parse results -- module
+// items, tables and the event log, all of which reference the source text by
+// offsets -- can be stored on disk and reused for as long as the source stays
+// the same. entries are keyed by the content hash and tagged with the version
+// of the tool; anything that doesn't match is a miss
+
+class ParseCache {
+protected:
+	enum {
+		Signature     = 0x4358444c, // LDXC
+		FormatVersion = 6,
+	};
+
+protected:
+	sl::String m_dir;
+	volatile int32_t m_hitCount;
+	volatile int32_t m_missCount;
+	volatile int32_t m_tempFileCount;
+
+public:
+	ParseCache();
+
+	bool
+	isOpen() {
+		return !m_dir.isEmpty();
+	}
+
+	size_t
+	getHitCount() {
+		return m_hitCount;
+	}
+
+	size_t
+	getMissCount() {
+		return m_missCount;
+	}
+
+	bool
+	open(const sl::StringRef& dir);
+
+	// long-running processes (watch mode) report hits and misses per build
+
+	void
+	resetStats() {
+		m_hitCount = 0;
+		m_missCount = 0;
+	}
+
+	static
+	uint64_t
+	hashSource(const sl::StringRef& source);
+
+	// the unit must have its source loaded, but nothing parsed yet; on a miss,
+	// the unit is left empty. both can be called from multiple threads
+
+	bool
+	load(
+		Unit* unit,
+		uint64_t hash
+	);
+
+	bool
+	store(
+		Unit* unit,
+		uint64_t hash
+	);
+
+protected:
+	sl::String
+	getFileName(uint64_t hash);
+
+	bool
+	loadFile(
+		uint64_t hash,
+		sl::Array<char>* buffer
+	);
+};
+
+//..............................................................................
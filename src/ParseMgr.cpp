@@ -0,0 +1,638 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "ParseMgr.h"
+#include "Lexer.h"
+#include "Parser.llk.h"
+
+//..............................................................................
+
+bool
+parseFile(Unit* unit) {
+	return
+		unit->m_source.open(unit->m_fileName) &&
+		parseUnit(unit);
+}
+
+// trailing comments (--!<) document the last declared item
+
+void
+addDoxyCommentToken(
+	Parser* parser,
+	const Token* token,
+	ModuleItem* lastDeclaredItem
+) {
+	sl::StringRef comment = token->m_data.m_string;
+
+	if (!comment.isEmpty() && comment[0] == '<')
+		comment = comment.getSubString(1);
+	else
+		lastDeclaredItem = NULL;
+
+	parser->addDoxyComment(
+		comment,
+		token->m_pos,
+		token->m_tokenKind == TokenKind_DoxyComment_sl,
+		lastDeclaredItem
+	);
+}
+
+// nothing gets declared in function bodies (declarations in nested scopes are
+// suppressed), so the parser only gets the header and the closing 'end' --
+// the tokens in between are skipped with a block keyword balancer. doxy
+// comments are still passed on (they may use explicit commands such as \fn);
+// a comment left pending by the body would otherwise attach to the next
+// declaration after it, so it's dropped at the end of the body. returns the
+// number of skipped tokens; the closing token stays in the lexer
+
+size_t
+skipFunctionBody(
+	Lexer* lexer,
+	Parser* parser
+) {
+	size_t level = 1;
+	size_t count = 0;
+	bool wasDoxyCommentPending = parser->isDoxyCommentPending(); // may belong to the statement
+
+	for (;;) {
+		const Token* token = lexer->getToken();
+
+		switch (token->m_token) {
+		case TokenKind_Eof:
+			return count; // let the parser report it
+
+		case TokenKind_DoxyComment_sl:
+		case TokenKind_DoxyComment_ml:
+			addDoxyCommentToken(parser, token, count ? NULL : parser->getLastDeclaredItem());
+			lexer->nextToken();
+			continue;
+
+		case TokenKind_Function:
+		case TokenKind_Do: // also opens bodies of 'while' and 'for'
+		case TokenKind_If:
+		case TokenKind_Repeat:
+			level++;
+			break;
+
+		case TokenKind_End:
+		case TokenKind_Until:
+			if (!--level) {
+				if (!wasDoxyCommentPending && parser->isDoxyCommentPending())
+					parser->dropPendingDoxyComment();
+
+				return count;
+			}
+
+			break;
+		}
+
+		lexer->nextToken();
+		count++;
+	}
+}
+
+// in data-table mode (--data-tables), fields of data tables (constructors
+// without doxy comments in undocumented statements) are never looked at, so
+// the parser only gets the braces; the constructor is still scanned by the
+// lexer, but no fields, values or events are produced. returns the number of
+// skipped tokens; '}' stays in the lexer
+
+size_t
+skipTableConstructor(
+	Lexer* lexer,
+	Parser* parser
+) {
+	size_t level = 1;
+	size_t count = 0;
+
+	for (;;) {
+		const Token* token = lexer->getToken();
+
+		switch (token->m_token) {
+		case TokenKind_Eof:
+			return count;
+
+		case TokenKind_DoxyComment_sl: // findDataTableEnd and the lexer disagree
+		case TokenKind_DoxyComment_ml:
+			addDoxyCommentToken(parser, token, NULL);
+			lexer->nextToken();
+			continue;
+
+		case '{':
+			level++;
+			break;
+
+		case '}':
+			if (!--level)
+				return count;
+
+			break;
+		}
+
+		lexer->nextToken();
+		count++;
+	}
+}
+
+bool
+parseUnit(
+	Unit* unit,
+	Module* bindModule
+) {
+	enum FunctionHeaderState {
+		FunctionHeaderState_None,
+		FunctionHeaderState_Name,   // after 'function'
+		FunctionHeaderState_Params, // after '('
+	};
+
+	bool result;
+
+	sl::StringRef source = unit->m_source.getSource();
+	if ((uint64_t)source.getLength() > 0xffffffff) { // source spans are 32-bit
+		err::setFormatStringError("%s: file too big", unit->m_fileName.sz());
+		return false;
+	}
+
+	unit->buildLineTable();
+
+	Lexer lexer;
+	Parser parser(unit);
+
+	lexer.create(source);
+	parser.create(unit->m_fileName, SymbolKind_block);
+
+	bool isDataTableMode = unit->m_module->m_isDataTableMode;
+	FunctionHeaderState headerState = FunctionHeaderState_None;
+	bool isEof = false;
+	do {
+		const Token* token = lexer.getToken();
+		int tokenKind = token->m_token;
+
+		if (tokenKind == TokenKind_DoxyComment_sl ||
+			tokenKind == TokenKind_DoxyComment_ml) {
+			addDoxyCommentToken(&parser, token, parser.getLastDeclaredItem());
+			lexer.nextToken();
+			continue;
+		}
+
+		isEof = tokenKind == TokenKind_Eof; // EOF token must be parsed
+
+		bool isDataTable = false;
+		if (tokenKind == '{' && isDataTableMode && !parser.isStatementDocumented()) {
+			size_t offset = token->m_pos.m_offset;
+			isDataTable = findDataTableEnd(source.cp() + offset, source.getLength() - offset) != -1;
+			if (isDataTable)
+				parser.setNextTableOpaque();
+		}
+
+		result = parser.consumeToken(lexer.takeToken());
+		if (!result)
+			return false;
+
+		unit->m_tokenCount++;
+
+		// watch function headers: 'function' [name] '(' params ')'
+
+		switch (headerState) {
+		case FunctionHeaderState_None:
+			if (tokenKind == TokenKind_Function)
+				headerState = FunctionHeaderState_Name;
+			break;
+
+		case FunctionHeaderState_Name:
+			if (tokenKind == '(')
+				headerState = FunctionHeaderState_Params;
+			else if (tokenKind != TokenKind_Identifier && tokenKind != '.' && tokenKind != ':')
+				headerState = FunctionHeaderState_None;
+			break;
+
+		case FunctionHeaderState_Params:
+			if (tokenKind == ')') {
+				unit->m_skippedTokenCount += skipFunctionBody(&lexer, &parser);
+				headerState = FunctionHeaderState_None;
+			} else if (tokenKind != TokenKind_Identifier && tokenKind != ',' && tokenKind != TokenKind_Ellipsis) {
+				headerState = FunctionHeaderState_None;
+			}
+
+			break;
+		}
+
+		if (isDataTable)
+			unit->m_skippedTokenCount += skipTableConstructor(&lexer, &parser);
+
+		if (bindModule) {
+			size_t count = unit->m_eventArray.getCount();
+			if (count > unit->m_boundEventCount &&
+				unit->m_eventArray[count - 1].m_eventKind == UnitEventKind_TopLevelStatement)
+				bindModule->bindUnit(unit);
+		}
+	} while (!isEof);
+
+	return true;
+}
+
+//..............................................................................
+
+ParseMgr::ParseMgr(Module* module) {
+	m_module = module;
+	m_nextJobIdx = 0;
+	m_threadCount = 1;
+	m_isStreaming = false;
+	m_isInputFinished = false;
+	m_isCancelled = false;
+	m_parsedFileCount = 0;
+	m_parseCache = NULL;
+	m_isVerbose = false;
+	m_isMappingDisabled = false;
+}
+
+void
+ParseMgr::resetStats() {
+	m_sourceReaderStats = SourceReaderStats();
+	m_parsedFileCount = 0;
+}
+
+void
+ParseMgr::clear() {
+	size_t count = m_jobArray.getCount();
+	for (size_t i = 0; i < count; i++)
+		delete m_jobArray[i];
+
+	m_jobArray.clear();
+}
+
+void
+ParseMgr::addFile(
+	const sl::StringRef& fileName,
+	size_t rank
+) {
+	SourceReadRequest* requestArray[MaxBatchSize];
+	size_t count = 0;
+
+	m_lock.lock();
+	createJob(fileName, rank);
+	m_jobEvent.signal();
+
+	// no worker threads -- parse on the adding thread as soon as a batch is full
+
+	if (m_isStreaming &&
+		m_threadCount < 2 &&
+		m_jobArray.getCount() - m_nextJobIdx >= MaxBatchSize)
+		count = takeJobBatch(requestArray);
+
+	m_lock.unlock();
+
+	if (count) {
+		m_sequentialLock.lock();
+		parseJobBatch(&m_sourceReader, requestArray, count);
+		m_sequentialLock.unlock();
+	}
+}
+
+void
+ParseMgr::updateFile(
+	const sl::StringRef& fileName,
+	size_t rank
+) {
+	// the same file may be listed explicitly and found in a source dir
+
+	sl::Array<size_t> rankArray;
+
+	size_t count = m_jobArray.getCount();
+	for (size_t i = 0; i < count;) {
+		Job* job = m_jobArray[i];
+		if (job->m_fileName != fileName) {
+			i++;
+			continue;
+		}
+
+		rankArray.append(job->m_rank);
+		m_module->removeUnit(job->m_unit);
+		m_jobArray.remove(i);
+		delete job;
+		count--;
+	}
+
+	if (!io::doesFileExist(fileName)) // deleted or renamed
+		return;
+
+	if (rankArray.isEmpty()) // created
+		rankArray.append(rank);
+
+	m_sourceReader.m_isMappingDisabled = m_isMappingDisabled;
+
+	count = rankArray.getCount();
+	for (size_t i = 0; i < count; i++) {
+		SourceReadRequest* request = createJob(fileName, rankArray[i]);
+		parseJobBatch(&m_sourceReader, &request, 1);
+	}
+
+	m_nextJobIdx = m_jobArray.getCount();
+}
+
+bool
+ParseMgr::rebind() {
+	m_module->unbind();
+
+	size_t count = m_jobArray.getCount();
+	std::sort(m_jobArray.p(), m_jobArray.p() + count, JobOrderCmp());
+
+	for (size_t i = 0; i < count; i++) {
+		Job* job = m_jobArray[i];
+		if (!job->m_result) {
+			err::setError(job->m_error);
+			return false;
+		}
+
+		m_module->bindUnit(job->m_unit);
+	}
+
+	return true;
+}
+
+ParseMgr::Job*
+ParseMgr::createJob(
+	const sl::StringRef& fileName,
+	size_t rank
+) {
+	Job* job = new Job;
+	job->m_unit = m_module->createUnit(fileName);
+	job->m_fileName = job->m_unit->m_fileName;
+	job->m_file = &job->m_unit->m_source;
+	job->m_rank = rank != -1 ? rank : m_jobArray.getCount();
+	m_jobArray.append(job);
+	return job;
+}
+
+bool
+ParseMgr::parse(size_t threadCount) {
+	if (!threadCount)
+		threadCount = g::getModule()->getSystemInfo()->m_processorCount;
+
+	size_t jobCount = m_jobArray.getCount();
+	if (!jobCount) // start (0) would spawn a thread per CPU
+		return true;
+
+	if (threadCount > jobCount)
+		threadCount = jobCount;
+
+	startParse(threadCount, false);
+	return finish();
+}
+
+void
+ParseMgr::start(size_t threadCount) {
+	if (!threadCount)
+		threadCount = g::getModule()->getSystemInfo()->m_processorCount;
+
+	startParse(threadCount, true);
+}
+
+void
+ParseMgr::startParse(
+	size_t threadCount,
+	bool isStreaming
+) {
+	m_nextJobIdx = 0;
+	m_threadCount = threadCount;
+	m_isStreaming = isStreaming;
+	m_isInputFinished = false;
+	m_isCancelled = false;
+	m_sourceReader.m_isMappingDisabled = m_isMappingDisabled;
+
+	if (threadCount < 2) // parse on the calling thread in finish () or addFile ()
+		return;
+
+	for (size_t i = 0; i < threadCount; i++) {
+		ParseThread* thread = new ParseThread(this);
+		thread->m_sourceReader.m_isMappingDisabled = m_isMappingDisabled;
+		m_threadList.insertTail(thread);
+		thread->start();
+	}
+}
+
+bool
+ParseMgr::finish() {
+	m_lock.lock();
+	m_isInputFinished = true;
+	m_jobEvent.signal();
+	m_lock.unlock();
+
+	if (!m_threadList.isEmpty())
+		return bindParallel();
+
+	if (!m_isStreaming)
+		return parseSequential();
+
+	// parse what's left after the last inline batch, then bind in the sorted
+	// order -- just like with worker threads
+
+	SourceReadRequest* requestArray[MaxBatchSize];
+
+	m_sequentialLock.lock();
+
+	for (;;) {
+		size_t count = getNextJobBatch(requestArray);
+		if (!count)
+			break;
+
+		parseJobBatch(&m_sourceReader, requestArray, count);
+	}
+
+	m_sourceReaderStats.add(m_sourceReader.getStats());
+	m_sequentialLock.unlock();
+
+	return bindParallel();
+}
+
+bool
+ParseMgr::parseCachedUnit(
+	Unit* unit,
+	Module* bindModule
+) {
+	if (!m_parseCache) {
+		sys::atomicInc(&m_parsedFileCount);
+		return parseUnit(unit, bindModule);
+	}
+
+	uint64_t hash = ParseCache::hashSource(unit->m_source.getSource());
+	if (m_module->m_isDataTableMode) // parse results differ, so entries can't be shared
+		hash = fnv1aHash("data-tables", 11, hash);
+
+	if (m_parseCache->load(unit, hash))
+		return true;
+
+	sys::atomicInc(&m_parsedFileCount);
+
+	// cached units must be stored before they get bound
+
+	bool result = parseUnit(unit);
+	if (!result)
+		return false;
+
+	m_parseCache->store(unit, hash); // a failure to cache is not an error
+	return true;
+}
+
+bool
+ParseMgr::parseSequential() {
+	std::sort(m_jobArray.p(), m_jobArray.p() + m_jobArray.getCount(), JobOrderCmp());
+
+	SourceReadRequest* requestArray[MaxBatchSize];
+
+	for (;;) {
+		size_t count = getNextJobBatch(requestArray);
+		if (!count)
+			break;
+
+		m_sourceReader.read(requestArray, count);
+
+		for (size_t i = 0; i < count; i++) {
+			Job* job = (Job*)requestArray[i];
+
+			if (m_isVerbose)
+				printf("Parsing %s...\n", job->m_fileName.sz());
+
+			if (!job->m_result) {
+				err::setError(job->m_error);
+				return false;
+			}
+
+			bool result = parseCachedUnit(job->m_unit, m_module);
+			if (!result)
+				return false;
+
+			m_module->bindUnit(job->m_unit);
+		}
+	}
+
+	m_sourceReaderStats.add(m_sourceReader.getStats());
+	return true;
+}
+
+bool
+ParseMgr::bindParallel() {
+	// worker threads take jobs in the order of addition; bind in the sorted order
+
+	size_t count = m_jobArray.getCount();
+
+	sl::Array<Job*> bindArray;
+	bindArray.copy(m_jobArray.cp(), count);
+	std::sort(bindArray.p(), bindArray.p() + count, JobOrderCmp());
+
+	bool result = true;
+
+	for (size_t i = 0; i < count; i++) {
+		Job* job = bindArray[i];
+		job->m_completionEvent.wait();
+
+		if (m_isVerbose)
+			printf("Parsing %s...\n", job->m_fileName.sz());
+
+		if (!job->m_result) {
+			err::setError(job->m_error);
+			result = false;
+			break;
+		}
+
+		m_module->bindUnit(job->m_unit);
+	}
+
+	m_lock.lock();
+	m_isCancelled = true;
+	m_jobEvent.signal();
+	m_lock.unlock();
+
+	while (!m_threadList.isEmpty()) {
+		ParseThread* thread = m_threadList.removeHead();
+		thread->waitAndClose();
+		m_sourceReaderStats.add(thread->m_sourceReader.getStats());
+		delete thread;
+	}
+
+	return result;
+}
+
+size_t
+ParseMgr::getNextJobBatch(SourceReadRequest** requestArray) {
+	m_lock.lock();
+
+	while (
+		m_nextJobIdx >= m_jobArray.getCount() &&
+		!m_isInputFinished &&
+		!m_isCancelled
+	) {
+		m_jobEvent.reset();
+		m_lock.unlock();
+		m_jobEvent.wait();
+		m_lock.lock();
+	}
+
+	size_t count = takeJobBatch(requestArray);
+	m_lock.unlock();
+
+	return count;
+}
+
+size_t
+ParseMgr::takeJobBatch(SourceReadRequest** requestArray) {
+	// smaller batches towards the end, so all the threads get some work
+
+	size_t count = m_jobArray.getCount();
+	size_t begin = m_nextJobIdx;
+	size_t batchSize = (count - begin) / (m_threadCount * 2);
+	size_t end = begin + AXL_MIN(AXL_MAX(batchSize, 1), MaxBatchSize);
+	if (end > count)
+		end = count;
+
+	for (size_t i = begin; i < end; i++)
+		requestArray[i - begin] = m_jobArray[i];
+
+	m_nextJobIdx = end;
+	return end - begin;
+}
+
+void
+ParseMgr::parseJobBatch(
+	SourceReader* sourceReader,
+	SourceReadRequest** requestArray,
+	size_t count
+) {
+	sourceReader->read(requestArray, count);
+
+	for (size_t i = 0; i < count; i++) {
+		Job* job = (Job*)requestArray[i];
+
+		if (job->m_result) {
+			job->m_result = parseCachedUnit(job->m_unit);
+			if (!job->m_result)
+				job->m_error = err::getLastError();
+		}
+
+		job->m_completionEvent.signal();
+	}
+}
+
+void
+ParseMgr::parseThreadFunc(SourceReader* sourceReader) {
+	SourceReadRequest* requestArray[MaxBatchSize];
+
+	while (!m_isCancelled) {
+		size_t count = getNextJobBatch(requestArray);
+		if (!count)
+			break;
+
+		parseJobBatch(sourceReader, requestArray, count);
+	}
+}
+
+//..............................................................................
@@ -0,0 +1,222 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+#include "SourceFile.h"
+#include "ParseCache.h"
+
+class Module;
+struct Unit;
+
+//..............................................................................
+
+// unit source must be already loaded; if bindModule is not NULL, events are
+// bound as soon as top-level statements complete (only on the binding thread!)
+
+bool
+parseUnit(
+	Unit* unit,
+	Module* bindModule = NULL
+);
+
+bool
+parseFile(Unit* unit);
+
+//..............................................................................
+
+// units are parsed on a pool of worker threads (possibly, while source files
+// are still being added), but bound to the module strictly in the order of
+// ranks and file names -- so the resulting module is exactly the same as if
+// source files were parsed one after another. with a single thread in the
+// streaming mode, addFile parses batches of files inline as they come.
+// in watch mode, units are kept between builds: only modified files are
+// parsed again, and then all the units are bound anew (see Module::unbind)
+
+class ParseMgr {
+protected:
+	enum {
+		MaxBatchSize = 32, // source files are read in batches
+	};
+
+	class ParseThread:
+		public sys::ThreadImpl<ParseThread>,
+		public sl::ListLink {
+	public:
+		ParseMgr* m_parseMgr;
+		SourceReader m_sourceReader;
+
+	public:
+		ParseThread(ParseMgr* parseMgr) {
+			m_parseMgr = parseMgr;
+		}
+
+		void
+		threadFunc() {
+			m_parseMgr->parseThreadFunc(&m_sourceReader);
+		}
+	};
+
+	struct Job: SourceReadRequest {
+		Unit* m_unit;
+		size_t m_rank;
+		sys::NotificationEvent m_completionEvent;
+
+		Job() {
+			m_unit = NULL;
+			m_rank = 0;
+		}
+	};
+
+	struct JobOrderCmp {
+		bool
+		operator () (
+			const Job* job1,
+			const Job* job2
+		) const {
+			return
+				job1->m_rank < job2->m_rank ||
+				(job1->m_rank == job2->m_rank && job1->m_fileName.cmp(job2->m_fileName) < 0);
+		}
+	};
+
+protected:
+	Module* m_module;
+	sl::Array<Job*> m_jobArray;
+	sl::List<ParseThread> m_threadList;
+	SourceReader m_sourceReader;
+	SourceReaderStats m_sourceReaderStats;
+	sys::Lock m_lock;
+	sys::NotificationEvent m_jobEvent; // signalled when new jobs are added
+	sys::Lock m_sequentialLock; // serializes inline parsing in addFile
+	size_t m_nextJobIdx;
+	size_t m_threadCount;
+	bool m_isStreaming;
+	bool m_isInputFinished;
+	volatile int32_t m_isCancelled;
+	volatile int32_t m_parsedFileCount; // not restored from the parse cache
+
+public:
+	ParseCache* m_parseCache; // optional
+	bool m_isVerbose;
+	bool m_isMappingDisabled; // for long-running modes, see SourceFile
+
+public:
+	ParseMgr(Module* module);
+
+	~ParseMgr() {
+		clear();
+	}
+
+	size_t
+	getFileCount() {
+		return m_jobArray.getCount();
+	}
+
+	const SourceReaderStats&
+	getSourceReaderStats() {
+		return m_sourceReaderStats;
+	}
+
+	size_t
+	getParsedFileCount() {
+		return m_parsedFileCount;
+	}
+
+	void
+	resetStats();
+
+	void
+	clear();
+
+	// rank is the primary binding order key (-1 = order of addition);
+	// files of the same rank are bound in the order of names
+
+	void
+	addFile(
+		const sl::StringRef& fileName,
+		size_t rank = -1
+	);
+
+	bool
+	parse(size_t threadCount = 1);
+
+	// streaming mode: start, add files (from any thread), finish
+
+	void
+	start(size_t threadCount = 1);
+
+	bool
+	finish();
+
+	// watch mode: drops units of the file and, unless it's deleted, parses it
+	// again (on the calling thread); rank only matters for new files
+
+	void
+	updateFile(
+		const sl::StringRef& fileName,
+		size_t rank
+	);
+
+	// binds all the units again, in the same order as finish ()
+
+	bool
+	rebind();
+
+protected:
+	// must be called under m_lock (or with no parsing in progress)
+
+	Job*
+	createJob(
+		const sl::StringRef& fileName,
+		size_t rank
+	);
+
+	bool
+	parseCachedUnit(
+		Unit* unit,
+		Module* bindModule = NULL
+	);
+
+	void
+	startParse(
+		size_t threadCount,
+		bool isStreaming
+	);
+
+	bool
+	parseSequential();
+
+	bool
+	bindParallel();
+
+	size_t
+	getNextJobBatch(SourceReadRequest** requestArray);
+
+	// must be called under m_lock; never waits for new jobs
+
+	size_t
+	takeJobBatch(SourceReadRequest** requestArray);
+
+	// results are stored in jobs (binding is done in the order of jobs)
+
+	void
+	parseJobBatch(
+		SourceReader* sourceReader,
+		SourceReadRequest** requestArray,
+		size_t count
+	);
+
+	void
+	parseThreadFunc(SourceReader* sourceReader);
+};
+
+//..............................................................................
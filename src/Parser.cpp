@@ -15,28 +15,76 @@
 
 //..............................................................................
 
-Parser::Parser(Module* module):
-	m_doxyParser(&module->m_doxyModule) {
-	m_module = module;
+Parser::Parser(Unit* unit) {
+	m_unit = unit;
 	m_lastDeclaredItem = NULL;
 	m_scopeLevel = 0;
+	m_isDoxyCommentPending = false;
+	m_isStatementDocumented = false;
+	m_isNextTableOpaque = false;
+}
+
+void
+Parser::addDoxyComment(
+	const sl::StringRef& comment,
+	const lex::LineCol& pos,
+	bool isSingleLine,
+	ModuleItem* lastDeclaredItem
+) {
+	UnitEvent event;
+	event.m_eventKind = UnitEventKind_DoxyComment;
+	event.m_scopeLevel = m_scopeLevel;
+	event.m_item = lastDeclaredItem;
+	event.m_comment = comment;
+	event.m_pos = pos;
+	event.m_isSingleLine = isSingleLine;
+	m_unit->m_eventArray.append(event);
+
+	if (!lastDeclaredItem)
+		m_isDoxyCommentPending = true;
+
+	m_isStatementDocumented = true;
+}
+
+void
+Parser::dropPendingDoxyComment() {
+	UnitEvent event;
+	event.m_eventKind = UnitEventKind_DropDoxyComment;
+	event.m_scopeLevel = m_scopeLevel;
+	m_unit->m_eventArray.append(event);
+
+	m_isDoxyCommentPending = false;
+}
+
+void
+Parser::addTopLevelStatementEvent() {
+	UnitEvent event;
+	event.m_eventKind = UnitEventKind_TopLevelStatement;
+	m_unit->m_eventArray.append(event);
 }
 
 Variable*
 Parser::declareVariable(
-	const Token::Pos& pos,
+	const SourceSpan& span,
 	const sl::StringRef& name,
 	ModuleItemKind itemKind
 ) {
-	bool isGlobalName = itemKind == ModuleItemKind_Variable;
-	Variable* variable = m_module->createVariable(name, itemKind);
-	finalizeDeclaration(pos, variable, isGlobalName);
+	Variable* variable = m_unit->createVariable(name, itemKind);
+
+	finalizeDeclaration(
+		span,
+		variable,
+		itemKind == ModuleItemKind_Variable ?
+			UnitEventKind_GlobalDeclaration :
+			UnitEventKind_Declaration
+	);
+
 	return variable;
 }
 
 size_t
 Parser::declareLocalVariables(
-	const Token::Pos& pos,
+	const SourceSpan& span,
 	const sl::BoxList<sl::StringRef>& nameList,
 	const sl::BoxList<Value>& initializerList
 ) {
@@ -44,7 +92,7 @@ Parser::declareLocalVariables(
 	sl::ConstBoxIterator<sl::StringRef> it1 = nameList.getHead();
 	sl::ConstBoxIterator<Value> it2 = initializerList.getHead();
 	for (; it1 && it2; it1++, it2++, count++) {
-		Variable* variable = declareVariable(pos, *it1);
+		Variable* variable = declareVariable(span, *it1);
 		variable->m_isLocal = true;
 		variable->m_initializer = *it2;
 	}
@@ -68,83 +116,71 @@ Parser::initializeVariables(
 
 Variable*
 Parser::declareIndexedField(
-	const Token::Pos& pos,
+	const SourceSpan& span,
 	const Value& index
 ) {
-	Variable* field = declareVariable(pos, NULL, ModuleItemKind_Field);
+	Variable* field = declareVariable(span, NULL, ModuleItemKind_Field);
 	field->m_index = index;
 	return field;
 }
 
 Variable*
 Parser::declareUnnamedField(
-	const Token::Pos& pos,
+	const SourceSpan& span,
 	const Value& initializer
 ) {
-	Variable* field = declareVariable(pos, NULL, ModuleItemKind_Field);
+	Variable* field = declareVariable(span, NULL, ModuleItemKind_Field);
 	field->setInitializer(initializer);
 	return field;
 }
 
 Function*
 Parser::declareFunction(
-	const Token::Pos& pos,
+	const SourceSpan& span,
 	FunctionName* name,
 	bool isLocal
 ) {
-	Function* function = m_module->createFunction(name->m_name);
+	Function* function = m_unit->createFunction(name->m_name);
 	function->m_isLocal = isLocal;
 
 	if (name->m_list.isEmpty()) {
-		finalizeDeclaration(pos, function, true);
+		finalizeDeclaration(span, function, UnitEventKind_GlobalDeclaration);
 		return function;
 	}
 
-	sl::BoxIterator<sl::StringRef> it = name->m_list.getHead();
-	Table* table = m_module->findTable(*it);
-	for (it++; table && it; it++)
-		table = m_module->findTableField(table, *it);
-
-	if (!table)
-		return NULL; // parent module/class must have been declared first
+	// the parent table is looked up when the unit gets bound to the module
+	// (or after all units are bound, if it's declared later or in another file)
 
 	function->m_isMethod = name->m_isMethod;
-	Variable* field = m_module->createVariable(name->m_name, ModuleItemKind_Field);
-	field->setInitializer(function);
-	table->addField(field);
-	finalizeDeclaration(pos, function);
+	sl::takeOver(&function->m_tableNameList, &name->m_list);
+	finalizeDeclaration(span, function, UnitEventKind_MethodDeclaration);
 	return function;
 }
 
 Function*
-Parser::declareFunction(const Token::Pos& pos) {
-	Function* function = m_module->createFunction();
-	finalizeDeclaration(pos, function);
+Parser::declareFunction(const SourceSpan& span) {
+	Function* function = m_unit->createFunction();
+	finalizeDeclaration(span, function);
 	return function;
 }
 
 void
 Parser::finalizeDeclaration(
-	const Token::Pos& pos,
+	const SourceSpan& span,
 	ModuleItem* item,
-	bool isGlobalName
+	UnitEventKind eventKind
 ) {
-	item->m_fileName = m_fileName;
-	item->m_pos = pos;
-
-	dox::Block* block = m_doxyParser.popBlock();
-	if (block) {
-		item->m_doxyBlock = block;
-		block->m_item = item;
-	}
+	item->m_isDeclared = true;
+	item->m_offset = span.m_offset;
 
-	if (isGlobalName && !item->m_name.isEmpty()) {
-		sl::StringHashTableIterator<ModuleItem*> it = m_module->m_itemMap.visit(item->m_name);
-		if (!it->m_value) // keep the original declaration
-			it->m_value = item;
-	}
+	UnitEvent event;
+	event.m_eventKind = eventKind;
+	event.m_scopeLevel = m_scopeLevel;
+	event.m_item = item;
+	m_unit->m_eventArray.append(event);
 
 	m_lastDeclaredItem = item;
+	m_isDoxyCommentPending = false;
 }
 
 //..............................................................................
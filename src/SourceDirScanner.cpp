@@ -0,0 +1,236 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "SourceDirScanner.h"
+#include "ParseMgr.h"
+
+#if (_AXL_OS_POSIX)
+#	include <sys/stat.h>
+#	include <dirent.h>
+#	include <errno.h>
+#endif
+
+//..............................................................................
+
+#if (_AXL_OS_POSIX)
+
+// only called when readdir can't tell the type for sure
+
+static
+int
+getFileType(
+	const sl::String& path,
+	int type
+) {
+	struct stat st;
+
+	if (type == DT_UNKNOWN) {
+		if (lstat(path.sz(), &st) != 0)
+			return DT_UNKNOWN;
+
+		type =
+			S_ISDIR(st.st_mode) ? DT_DIR :
+			S_ISREG(st.st_mode) ? DT_REG :
+			S_ISLNK(st.st_mode) ? DT_LNK :
+			DT_UNKNOWN;
+	}
+
+	if (type != DT_LNK)
+		return type;
+
+	// follow symlinks to files, but not to directories (no cycles this way)
+
+	return stat(path.sz(), &st) == 0 && S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN;
+}
+
+#endif
+
+//..............................................................................
+
+SourceDirScanner::SourceDirScanner(ParseMgr* parseMgr) {
+	m_parseMgr = parseMgr;
+	m_activeThreadCount = 0;
+	m_fileCount = 0;
+	m_isRecursive = false;
+}
+
+void
+SourceDirScanner::addDir(
+	const sl::StringRef& dirName,
+	size_t rank
+) {
+	if (dirName.isEmpty())
+		return;
+
+	Dir dir;
+	dir.m_path = dirName;
+
+	char c = dirName[dirName.getLength() - 1];
+#if (_AXL_OS_WIN)
+	if (c != '/' && c != '\\')
+#else
+	if (c != '/')
+#endif
+		dir.m_path += '/';
+
+	dir.m_rootLength = dir.m_path.getLength();
+	dir.m_rank = rank;
+	m_dirStack.append(dir);
+}
+
+void
+SourceDirScanner::scan(size_t threadCount) {
+	if (!threadCount)
+		threadCount = g::getModule()->getSystemInfo()->m_processorCount;
+
+	m_activeThreadCount = 0;
+
+	if (threadCount < 2) {
+		scanThreadFunc();
+		return;
+	}
+
+	sl::List<ScanThread> threadList;
+	for (size_t i = 0; i < threadCount; i++) {
+		ScanThread* thread = new ScanThread(this);
+		threadList.insertTail(thread);
+		thread->start();
+	}
+
+	sl::Iterator<ScanThread> it = threadList.getHead();
+	for (; it; it++)
+		it->waitAndClose();
+}
+
+void
+SourceDirScanner::scanThreadFunc() {
+	Dir dir;
+	while (getNextDir(&dir))
+		scanDir(dir);
+}
+
+bool
+SourceDirScanner::getNextDir(Dir* dir) {
+	m_lock.lock();
+
+	while (m_dirStack.isEmpty()) {
+		if (!m_activeThreadCount) { // nothing left to scan
+			m_lock.unlock();
+			return false;
+		}
+
+		m_dirEvent.reset();
+		m_lock.unlock();
+		m_dirEvent.wait();
+		m_lock.lock();
+	}
+
+	*dir = m_dirStack.getBackAndPop();
+	m_activeThreadCount++;
+	m_lock.unlock();
+	return true;
+}
+
+void
+SourceDirScanner::finalizeDir(
+	const sl::Array<Dir>& subdirArray,
+	size_t fileCount
+) {
+	m_lock.lock();
+	m_dirStack.append(subdirArray.cp(), subdirArray.getCount());
+	m_fileCount += fileCount;
+	m_activeThreadCount--;
+	m_dirEvent.signal(); // new dirs or, possibly, the end of the scan
+	m_lock.unlock();
+}
+
+void
+SourceDirScanner::scanDir(const Dir& dir) {
+	sl::Array<Dir> subdirArray;
+	size_t fileCount = 0;
+
+#if (_AXL_OS_POSIX)
+	DIR* h = opendir(dir.m_path.sz());
+	if (!h) {
+		err::setErrno(errno);
+		fprintf(stderr, "warning: %s: %s\n", dir.m_path.sz(), err::getLastErrorDescription().sz());
+	} else {
+		struct dirent* entry;
+		while ((entry = readdir(h))) {
+			const char* name = entry->d_name;
+			if (name[0] == '.' && (!name[1] || (name[1] == '.' && !name[2])))
+				continue;
+
+			int type = entry->d_type;
+			if (type == DT_UNKNOWN || type == DT_LNK)
+				type = getFileType(dir.m_path + name, type);
+
+			if (type == DT_DIR || type == DT_REG)
+				fileCount += addDirEntry(&subdirArray, dir, name, type == DT_DIR);
+		}
+
+		closedir(h);
+	}
+#else
+	io::FileEnumerator fileEnum;
+	bool result = fileEnum.openDir(dir.m_path);
+	if (!result) {
+		fprintf(stderr, "warning: %s: %s\n", dir.m_path.sz(), err::getLastErrorDescription().sz());
+	} else {
+		while (fileEnum.hasNextFile()) {
+			sl::String name = fileEnum.getNextFileName();
+			if (name == "." || name == "..")
+				continue;
+
+			bool isDir = io::isDir(dir.m_path + name);
+			fileCount += addDirEntry(&subdirArray, dir, name, isDir);
+		}
+	}
+#endif
+
+	finalizeDir(subdirArray, fileCount);
+}
+
+bool
+SourceDirScanner::addDirEntry(
+	sl::Array<Dir>* subdirArray,
+	const Dir& dir,
+	const sl::StringRef& name,
+	bool isDir
+) {
+	sl::String path = dir.m_path + name;
+	sl::StringRef relativePath = path.getSubString(dir.m_rootLength);
+
+	if (!m_excludeSet.isEmpty() && m_excludeSet.match(relativePath, name, isDir))
+		return false;
+
+	if (isDir) {
+		if (m_isRecursive) {
+			Dir subdir;
+			subdir.m_path = path;
+			subdir.m_path += '/';
+			subdir.m_rootLength = dir.m_rootLength;
+			subdir.m_rank = dir.m_rank;
+			subdirArray->append(subdir);
+		}
+
+		return false;
+	}
+
+	if (!m_includeSet.match(relativePath, name, false))
+		return false;
+
+	m_parseMgr->addFile(path, dir.m_rank);
+	return true;
+}
+
+//..............................................................................
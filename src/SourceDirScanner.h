@@ -0,0 +1,104 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+#include "Glob.h"
+
+class ParseMgr;
+
+//..............................................................................
+
+// walks source directories on a pool of threads and passes matching files to
+// the parse manager as soon as they are found; the binding order is restored
+// by the parse manager (files of a source directory share the same rank)
+
+class SourceDirScanner {
+protected:
+	class ScanThread:
+		public sys::ThreadImpl<ScanThread>,
+		public sl::ListLink {
+	protected:
+		SourceDirScanner* m_scanner;
+
+	public:
+		ScanThread(SourceDirScanner* scanner) {
+			m_scanner = scanner;
+		}
+
+		void
+		threadFunc() {
+			m_scanner->scanThreadFunc();
+		}
+	};
+
+	struct Dir {
+		sl::String m_path; // always ends with a slash
+		size_t m_rootLength;
+		size_t m_rank;
+	};
+
+protected:
+	ParseMgr* m_parseMgr;
+	sl::Array<Dir> m_dirStack;
+	sys::Lock m_lock;
+	sys::NotificationEvent m_dirEvent; // signalled when new dirs are pushed or the scan is over
+	size_t m_activeThreadCount; // threads currently scanning a directory
+	size_t m_fileCount;
+
+public:
+	GlobSet m_includeSet;
+	GlobSet m_excludeSet;
+	bool m_isRecursive;
+
+public:
+	SourceDirScanner(ParseMgr* parseMgr);
+
+	size_t
+	getFileCount() {
+		return m_fileCount;
+	}
+
+	void
+	addDir(
+		const sl::StringRef& dir,
+		size_t rank
+	);
+
+	void
+	scan(size_t threadCount = 1);
+
+protected:
+	void
+	scanThreadFunc();
+
+	bool
+	getNextDir(Dir* dir);
+
+	void
+	scanDir(const Dir& dir);
+
+	void
+	finalizeDir(
+		const sl::Array<Dir>& subdirArray,
+		size_t fileCount
+	);
+
+	bool
+	addDirEntry(
+		sl::Array<Dir>* subdirArray,
+		const Dir& dir,
+		const sl::StringRef& name,
+		bool isDir
+	);
+};
+
+//..............................................................................
@@ -0,0 +1,708 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "SourceFile.h"
+
+#if (_AXL_OS_POSIX)
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+#	include <errno.h>
+#endif
+
+//..............................................................................
+
+#if (_AXL_OS_POSIX)
+
+SourceSlab*
+SourceSlab::create(size_t size) {
+	SourceSlab* slab = (SourceSlab*)malloc(sizeof(SourceSlab) + size);
+	if (!slab)
+		return NULL;
+
+	slab->m_refCount = 1;
+	return slab;
+}
+
+#endif
+
+//..............................................................................
+
+SourceFile::SourceFile() {
+	m_sourceFileKind = SourceFileKind_Empty;
+	m_p = "";
+	m_size = 0;
+
+#if (_AXL_OS_POSIX)
+	m_mapping = NULL;
+	m_mappingSize = 0;
+	m_slab = NULL;
+#endif
+}
+
+#if (_AXL_OS_POSIX)
+
+bool
+SourceFile::open(const sl::StringRef& fileName) {
+	close();
+
+	int fd = ::open(fileName.sz(), O_RDONLY);
+	if (fd == -1) {
+		err::setErrno(errno);
+		return false;
+	}
+
+	struct stat st;
+	int result = ::fstat(fd, &st);
+	if (result == -1) {
+		err::setErrno(errno);
+		::close(fd);
+		return false;
+	}
+
+	bool isOk = map(fd, st.st_size);
+	::close(fd);
+	return isOk;
+}
+
+bool
+SourceFile::map(
+	int fd,
+	size_t size
+) {
+	close();
+
+	if (!size)
+		return true;
+
+	// the tail of the last page is zero-filled by the kernel; if the file size
+	// is page-aligned, reserve an extra anonymous (zero) page past the end
+
+	size_t pageSize = g::getModule()->getSystemInfo()->m_pageSize;
+	size_t mappingSize = (size + pageSize) & ~(pageSize - 1);
+
+#if (_AXL_OS_LINUX)
+	int flags = MAP_PRIVATE | MAP_POPULATE; // pre-fault: we are going to read it all anyway
+#else
+	int flags = MAP_PRIVATE;
+#endif
+
+	void* p;
+	if (size & (pageSize - 1)) {
+		p = ::mmap(NULL, size, PROT_READ, flags, fd, 0);
+	} else {
+		p = ::mmap(NULL, mappingSize, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (p != MAP_FAILED && ::mmap(p, size, PROT_READ, flags | MAP_FIXED, fd, 0) == MAP_FAILED) {
+			int error = errno;
+			::munmap(p, mappingSize);
+			errno = error;
+			p = MAP_FAILED;
+		}
+	}
+
+	if (p == MAP_FAILED) {
+		err::setErrno(errno);
+		return false;
+	}
+
+	::madvise(p, size, MADV_SEQUENTIAL);
+#if (!_AXL_OS_LINUX)
+	::madvise(p, size, MADV_WILLNEED);
+#endif
+
+	m_sourceFileKind = SourceFileKind_Mapped;
+	m_mapping = p;
+	m_mappingSize = mappingSize;
+	m_p = (const char*)p;
+	m_size = size;
+	return true;
+}
+
+void
+SourceFile::attachBuffer(
+	SourceSlab* slab,
+	char* p,
+	size_t size
+) {
+	ASSERT(!p[size]);
+
+	close();
+
+	slab->addRef();
+
+	m_sourceFileKind = SourceFileKind_Buffer;
+	m_slab = slab;
+	m_p = p;
+	m_size = size;
+}
+
+void
+SourceFile::close() {
+	switch (m_sourceFileKind) {
+	case SourceFileKind_Mapped:
+		::munmap(m_mapping, m_mappingSize);
+		m_mapping = NULL;
+		m_mappingSize = 0;
+		break;
+
+	case SourceFileKind_Buffer:
+		m_slab->release();
+		m_slab = NULL;
+		break;
+
+	case SourceFileKind_Copy:
+		m_copy.clear();
+		break;
+	}
+
+	m_sourceFileKind = SourceFileKind_Empty;
+	m_p = "";
+	m_size = 0;
+}
+
+#else
+
+bool
+SourceFile::open(const sl::StringRef& fileName) {
+	close();
+
+	bool result = m_file.open(fileName, io::FileFlag_ReadOnly);
+	if (!result)
+		return false;
+
+	m_sourceFileKind = SourceFileKind_Mapped;
+	m_p = (const char*)m_file.p();
+	m_size = m_file.getMappingSize();
+
+	// no room for the terminating zero in the last page -- fall back to a copy
+
+	size_t pageSize = g::getModule()->getSystemInfo()->m_pageSize;
+	if (!(m_size & (pageSize - 1))) {
+		m_buffer.copy(m_p, m_size);
+		m_file.close();
+		m_sourceFileKind = SourceFileKind_Buffer;
+		m_p = m_buffer;
+	}
+
+	return true;
+}
+
+void
+SourceFile::close() {
+	m_file.close();
+	m_buffer.clear();
+	m_copy.clear();
+	m_sourceFileKind = SourceFileKind_Empty;
+	m_p = "";
+	m_size = 0;
+}
+
+#endif
+
+void
+SourceFile::copy(const sl::StringRef& source) {
+	close();
+
+	m_copy = source; // sl::String is always zero-terminated
+	m_sourceFileKind = SourceFileKind_Copy;
+	m_p = m_copy.sz();
+	m_size = m_copy.getLength();
+}
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+uint64_t
+fnv1aHash(
+	const void* p0,
+	size_t size,
+	uint64_t hash
+) {
+	const uchar_t* p = (const uchar_t*)p0;
+	const uchar_t* end = p + size;
+	for (; p < end; p++) {
+		hash ^= *p;
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+
+//..............................................................................
+
+#if (_LUADOXYXML_IO_URING)
+
+IoUring::IoUring() {
+	m_fd = -1;
+	m_entryCount = 0;
+	m_sqRing = NULL;
+	m_sqRingSize = 0;
+	m_sqHead = NULL;
+	m_sqTail = NULL;
+	m_sqIndexArray = NULL;
+	m_sqMask = 0;
+	m_sqLocalTail = 0;
+	m_sqeArray = NULL;
+	m_sqeArraySize = 0;
+	m_cqRing = NULL;
+	m_cqRingSize = 0;
+	m_cqHead = NULL;
+	m_cqTail = NULL;
+	m_cqMask = 0;
+	m_cqeArray = NULL;
+}
+
+bool
+IoUring::open(uint_t entryCount) {
+	close();
+
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+
+	int fd = (int)::syscall(__NR_io_uring_setup, entryCount, &params);
+	if (fd == -1) {
+		err::setErrno(errno);
+		return false;
+	}
+
+	m_fd = fd;
+	m_entryCount = params.sq_entries;
+	m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+	m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	m_sqeArraySize = params.sq_entries * sizeof(io_uring_sqe);
+
+	bool isSingleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (isSingleMmap)
+		m_sqRingSize = m_cqRingSize = AXL_MAX(m_sqRingSize, m_cqRingSize);
+
+	void* sqRing = ::mmap(NULL, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	if (sqRing == MAP_FAILED) {
+		err::setErrno(errno);
+		close();
+		return false;
+	}
+
+	m_sqRing = sqRing;
+
+	void* cqRing = isSingleMmap ? sqRing :
+		::mmap(NULL, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+
+	if (cqRing == MAP_FAILED) {
+		err::setErrno(errno);
+		close();
+		return false;
+	}
+
+	m_cqRing = cqRing;
+
+	void* sqeArray = ::mmap(NULL, m_sqeArraySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+	if (sqeArray == MAP_FAILED) {
+		err::setErrno(errno);
+		close();
+		return false;
+	}
+
+	m_sqeArray = (io_uring_sqe*)sqeArray;
+
+	char* sq = (char*)sqRing;
+	m_sqHead = (uint32_t*)(sq + params.sq_off.head);
+	m_sqTail = (uint32_t*)(sq + params.sq_off.tail);
+	m_sqMask = *(uint32_t*)(sq + params.sq_off.ring_mask);
+	m_sqIndexArray = (uint32_t*)(sq + params.sq_off.array);
+	m_sqLocalTail = *m_sqTail;
+
+	char* cq = (char*)cqRing;
+	m_cqHead = (uint32_t*)(cq + params.cq_off.head);
+	m_cqTail = (uint32_t*)(cq + params.cq_off.tail);
+	m_cqMask = *(uint32_t*)(cq + params.cq_off.ring_mask);
+	m_cqeArray = (io_uring_cqe*)(cq + params.cq_off.cqes);
+	return true;
+}
+
+void
+IoUring::close() {
+	if (m_sqeArray)
+		::munmap(m_sqeArray, m_sqeArraySize);
+
+	if (m_cqRing && m_cqRing != m_sqRing)
+		::munmap(m_cqRing, m_cqRingSize);
+
+	if (m_sqRing)
+		::munmap(m_sqRing, m_sqRingSize);
+
+	if (m_fd != -1)
+		::close(m_fd);
+
+	m_fd = -1;
+	m_entryCount = 0;
+	m_sqRing = NULL;
+	m_cqRing = NULL;
+	m_sqeArray = NULL;
+}
+
+io_uring_sqe*
+IoUring::getSqe() {
+	uint32_t head = __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+	if (m_sqLocalTail - head >= m_entryCount)
+		return NULL;
+
+	uint32_t i = m_sqLocalTail & m_sqMask;
+	m_sqIndexArray[i] = i;
+	m_sqLocalTail++;
+
+	io_uring_sqe* sqe = &m_sqeArray[i];
+	memset(sqe, 0, sizeof(io_uring_sqe));
+	return sqe;
+}
+
+int
+IoUring::enter(
+	uint_t submitCount,
+	uint_t waitCount,
+	uint_t flags
+) {
+	return (int)::syscall(
+		__NR_io_uring_enter,
+		m_fd,
+		submitCount,
+		waitCount,
+		flags,
+		NULL,
+		0
+	);
+}
+
+bool
+IoUring::submit(uint_t* submitCount) {
+	__atomic_store_n(m_sqTail, m_sqLocalTail, __ATOMIC_RELEASE);
+
+	*submitCount = 0;
+
+	for (;;) {
+		uint32_t pendingCount = m_sqLocalTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+		if (!pendingCount)
+			return true;
+
+		int result = enter(pendingCount, 0, 0);
+		if (result > 0) {
+			*submitCount += result;
+		} else if (!result) { // nothing taken -- don't spin
+			err::setErrno(EAGAIN);
+			return false;
+		} else if (errno != EINTR) {
+			err::setErrno(errno);
+			return false;
+		}
+	}
+}
+
+bool
+IoUring::wait(uint_t waitCount) {
+	for (;;) {
+		uint32_t readyCount = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE) - *m_cqHead;
+		if (readyCount >= waitCount)
+			return true;
+
+		int result = enter(0, waitCount, IORING_ENTER_GETEVENTS);
+		if (result == -1 && errno != EINTR) {
+			err::setErrno(errno);
+			return false;
+		}
+	}
+}
+
+bool
+IoUring::getCqe(io_uring_cqe* cqe) {
+	uint32_t head = *m_cqHead;
+	uint32_t tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+	if (head == tail)
+		return false;
+
+	*cqe = m_cqeArray[head & m_cqMask];
+	__atomic_store_n(m_cqHead, head + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+#endif
+
+//..............................................................................
+
+SourceReader::SourceReader() {
+	m_isMappingDisabled = false;
+
+#if (_LUADOXYXML_IO_URING)
+	m_isRingFailed = false;
+#endif
+}
+
+#if (_AXL_OS_POSIX)
+
+void
+SourceReader::read(
+	SourceReadRequest* const* requestArray,
+	size_t count
+) {
+	m_pendingReadArray.clear();
+
+	size_t slabSize = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		SourceReadRequest* request = requestArray[i];
+		request->m_result = false;
+
+		int fd = ::open(request->m_fileName.sz(), O_RDONLY);
+		if (fd == -1) {
+			err::setErrno(errno);
+			request->m_error = err::getLastError();
+			continue;
+		}
+
+		struct stat st;
+		int result = ::fstat(fd, &st);
+		if (result == -1) {
+			err::setErrno(errno);
+			request->m_error = err::getLastError();
+			::close(fd);
+			continue;
+		}
+
+		size_t size = st.st_size;
+		if (!size) {
+			request->m_file->close();
+			request->m_result = true;
+			::close(fd);
+			continue;
+		}
+
+		if (size > SourceFile::SmallFileSizeLimit && !m_isMappingDisabled) {
+			request->m_result = request->m_file->map(fd, size);
+			if (request->m_result)
+				m_stats.m_mappedFileCount++;
+			else
+				request->m_error = err::getLastError();
+
+			::close(fd);
+			continue;
+		}
+
+		PendingRead pendingRead;
+		pendingRead.m_request = request;
+		pendingRead.m_fd = fd;
+		pendingRead.m_p = NULL;
+		pendingRead.m_size = size;
+		pendingRead.m_isCompleted = false;
+		m_pendingReadArray.append(pendingRead);
+		slabSize += size + 1;
+	}
+
+	size_t pendingCount = m_pendingReadArray.getCount();
+	if (!pendingCount)
+		return;
+
+	SourceSlab* slab = SourceSlab::create(slabSize);
+	if (!slab) {
+		err::setError(err::SystemErrorCode_InsufficientResources);
+
+		for (size_t i = 0; i < pendingCount; i++) {
+			m_pendingReadArray[i].m_request->m_error = err::getLastError();
+			::close(m_pendingReadArray[i].m_fd);
+		}
+
+		return;
+	}
+
+	char* p = slab->p();
+	for (size_t i = 0; i < pendingCount; i++) {
+		PendingRead* pendingRead = &m_pendingReadArray[i];
+		pendingRead->m_p = p;
+		p[pendingRead->m_size] = 0;
+		pendingRead->m_request->m_file->attachBuffer(slab, p, pendingRead->m_size);
+		p += pendingRead->m_size + 1;
+	}
+
+#if (_LUADOXYXML_IO_URING)
+	if (!m_ring.isOpen() && !m_isRingFailed) // io_uring may be missing or disabled
+		m_isRingFailed = !m_ring.open(RingEntryCount);
+
+	if (!m_isRingFailed)
+		readPendingUring(slab);
+#endif
+
+	readPendingPread(); // whatever is not completed yet
+	slab->release(); // now it's only referenced by the files
+
+	for (size_t i = 0; i < pendingCount; i++)
+		::close(m_pendingReadArray[i].m_fd);
+}
+
+void
+SourceReader::readPendingPread() {
+	size_t count = m_pendingReadArray.getCount();
+	for (size_t i = 0; i < count; i++) {
+		PendingRead* pendingRead = &m_pendingReadArray[i];
+		if (pendingRead->m_isCompleted)
+			continue;
+
+		bool result = readFile(*pendingRead);
+		completePendingRead(pendingRead, result);
+		m_stats.m_preadFileCount++;
+	}
+}
+
+bool
+SourceReader::readFile(
+	const PendingRead& pendingRead,
+	size_t offset
+) {
+	while (offset < pendingRead.m_size) {
+		ssize_t result = ::pread(
+			pendingRead.m_fd,
+			pendingRead.m_p + offset,
+			pendingRead.m_size - offset,
+			offset
+		);
+
+		if (result > 0) {
+			offset += result;
+		} else if (!result) {
+			err::setFormatStringError("unexpected end of file '%s'", pendingRead.m_request->m_fileName.sz());
+			return false;
+		} else if (errno != EINTR) {
+			err::setErrno(errno);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void
+SourceReader::completePendingRead(
+	PendingRead* pendingRead,
+	bool result
+) {
+	pendingRead->m_isCompleted = true;
+
+	SourceReadRequest* request = pendingRead->m_request;
+	request->m_result = result;
+	if (!result) {
+		request->m_error = err::getLastError();
+		request->m_file->close();
+	}
+}
+
+#	if (_LUADOXYXML_IO_URING)
+
+void
+SourceReader::readPendingUring(SourceSlab* slab) {
+	size_t count = m_pendingReadArray.getCount();
+	m_iovecArray.setCount(count);
+
+	size_t entryCount = m_ring.getEntryCount();
+	for (size_t i = 0; i < count; i += entryCount) {
+		size_t batchCount = AXL_MIN(entryCount, count - i);
+
+		for (size_t j = i; j < i + batchCount; j++) {
+			const PendingRead& pendingRead = m_pendingReadArray[j];
+
+			iovec* iov = &m_iovecArray[j];
+			iov->iov_base = pendingRead.m_p;
+			iov->iov_len = pendingRead.m_size;
+
+			io_uring_sqe* sqe = m_ring.getSqe();
+			ASSERT(sqe);
+
+			sqe->opcode = IORING_OP_READV;
+			sqe->fd = pendingRead.m_fd;
+			sqe->addr = (uint64_t)(uintptr_t)iov;
+			sqe->len = 1;
+			sqe->off = 0;
+			sqe->user_data = j;
+		}
+
+		// the kernel takes entries in order, so reads [i, i + submitCount) are
+		// in flight; the rest of the batch (if any) is left for pread
+
+		uint_t submitCount;
+		bool isSubmitted = m_ring.submit(&submitCount);
+		bool isDrained = m_ring.wait(submitCount);
+
+		err::Error waitError;
+		if (!isDrained)
+			waitError = err::getLastError();
+
+		io_uring_cqe cqe;
+		while (m_ring.getCqe(&cqe)) {
+			PendingRead* pendingRead = &m_pendingReadArray[(size_t)cqe.user_data];
+
+			if (cqe.res < 0) // leave it for pread
+				continue;
+
+			if ((size_t)cqe.res < pendingRead->m_size) { // short read, finish with pread
+				bool result = readFile(*pendingRead, cqe.res);
+				completePendingRead(pendingRead, result);
+				m_stats.m_preadFileCount++;
+			} else {
+				completePendingRead(pendingRead, true);
+				m_stats.m_uringFileCount++;
+			}
+		}
+
+		if (isSubmitted && isDrained)
+			continue;
+
+		if (!isDrained) {
+			// reads still in flight may write to their buffers at any moment,
+			// so these can't be re-read with pread and the slab can't ever be
+			// freed (let alone reused) -- fail them and leak the slab
+
+			slab->addRef();
+
+			for (size_t j = i; j < i + submitCount; j++) {
+				PendingRead* pendingRead = &m_pendingReadArray[j];
+				if (!pendingRead->m_isCompleted) {
+					err::setError(waitError);
+					completePendingRead(pendingRead, false);
+				}
+			}
+		}
+
+		// drop the ring for good; pread will read everything else
+
+		m_ring.close();
+		m_isRingFailed = true;
+		return;
+	}
+}
+
+#	endif
+
+#else
+
+void
+SourceReader::read(
+	SourceReadRequest* const* requestArray,
+	size_t count
+) {
+	for (size_t i = 0; i < count; i++) {
+		SourceReadRequest* request = requestArray[i];
+		request->m_result = request->m_file->open(request->m_fileName);
+		if (request->m_result)
+			m_stats.m_mappedFileCount++;
+		else
+			request->m_error = err::getLastError();
+	}
+}
+
+#endif
+
+//..............................................................................
@@ -0,0 +1,356 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+#if (_AXL_OS_LINUX)
+#	include <linux/io_uring.h>
+#	include <sys/syscall.h>
+#	include <sys/uio.h>
+#	if (defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter))
+#		define _LUADOXYXML_IO_URING 1
+#	endif
+#endif
+
+//..............................................................................
+
+enum SourceFileKind {
+	SourceFileKind_Empty,
+	SourceFileKind_Mapped,
+	SourceFileKind_Buffer,
+	SourceFileKind_Copy,
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+#if (_AXL_OS_POSIX)
+
+// small source files of a batch are read into a single slab, each taking
+// exactly its size plus the terminating zero; the slab is freed once all the
+// files in it are closed
+
+class SourceSlab {
+protected:
+	volatile int32_t m_refCount;
+
+public:
+	// the new slab has a single reference
+
+	static
+	SourceSlab*
+	create(size_t size);
+
+	char*
+	p() {
+		return (char*)(this + 1);
+	}
+
+	void
+	addRef() {
+		sys::atomicInc(&m_refCount);
+	}
+
+	void
+	release() {
+		if (!sys::atomicDec(&m_refCount))
+			free(this);
+	}
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+#endif
+
+// read-only view of a source file; module items reference the source directly,
+// so the file must stay open for as long as the module is alive. there is
+// always a zero byte after the last character of the source
+
+// on POSIX, mapped pages are backed by the file itself: if the file gets
+// truncated while mapped, touching the lost pages raises SIGBUS. this is
+// acceptable for a one-shot build, but long-running modes (--watch, the
+// filter server) must read sources into memory instead (see
+// SourceReader::m_isMappingDisabled). Windows doesn't allow truncating files
+// with mapped views, so there's no such hazard there
+
+class SourceFile {
+public:
+	enum {
+		SmallFileSizeLimit = 8 * 1024, // larger files are mapped
+	};
+
+protected:
+	SourceFileKind m_sourceFileKind;
+	const char* m_p;
+	size_t m_size;
+	sl::String m_copy;
+
+#if (_AXL_OS_POSIX)
+	void* m_mapping;
+	size_t m_mappingSize;
+	SourceSlab* m_slab;
+#else
+	io::SimpleMappedFile m_file;
+	sl::String m_buffer;
+#endif
+
+public:
+	SourceFile();
+
+	~SourceFile() {
+		close();
+	}
+
+	SourceFileKind
+	getSourceFileKind() const {
+		return m_sourceFileKind;
+	}
+
+	sl::StringRef
+	getSource() const {
+		return sl::StringRef(m_p, m_size);
+	}
+
+	size_t
+	getSize() const {
+		return m_size;
+	}
+
+	bool
+	open(const sl::StringRef& fileName);
+
+	void
+	close();
+
+	// for sources which don't come from files (e.g. generated benchmarks)
+
+	void
+	copy(const sl::StringRef& source);
+
+#if (_AXL_OS_POSIX)
+	bool
+	map(
+		int fd,
+		size_t size
+	);
+
+	// the source is at p inside the slab (followed by a zero byte); the file
+	// keeps a reference to the slab until closed
+
+	void
+	attachBuffer(
+		SourceSlab* slab,
+		char* p,
+		size_t size
+	);
+#endif
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+// 64-bit FNV-1a, used to tell whether sources changed between runs; hash a
+// sequence of blocks by passing the previous result as the initial hash
+
+uint64_t
+fnv1aHash(
+	const void* p,
+	size_t size,
+	uint64_t hash = 0xcbf29ce484222325ULL
+);
+
+//..............................................................................
+
+struct SourceReadRequest {
+	sl::String m_fileName;
+	SourceFile* m_file;
+	bool m_result;
+	err::Error m_error;
+
+	SourceReadRequest() {
+		m_file = NULL;
+		m_result = false;
+	}
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+struct SourceReaderStats {
+	size_t m_mappedFileCount;
+	size_t m_uringFileCount;
+	size_t m_preadFileCount;
+
+	SourceReaderStats() {
+		m_mappedFileCount = 0;
+		m_uringFileCount = 0;
+		m_preadFileCount = 0;
+	}
+
+	void
+	add(const SourceReaderStats& stats) {
+		m_mappedFileCount += stats.m_mappedFileCount;
+		m_uringFileCount += stats.m_uringFileCount;
+		m_preadFileCount += stats.m_preadFileCount;
+	}
+};
+
+//..............................................................................
+
+#if (_LUADOXYXML_IO_URING)
+
+// minimal io_uring wrapper (raw syscalls, no liburing dependency)
+
+class IoUring {
+protected:
+	int m_fd;
+	uint_t m_entryCount;
+
+	void* m_sqRing;
+	size_t m_sqRingSize;
+	uint32_t* m_sqHead;
+	uint32_t* m_sqTail;
+	uint32_t* m_sqIndexArray;
+	uint32_t m_sqMask;
+	uint32_t m_sqLocalTail;
+	io_uring_sqe* m_sqeArray;
+	size_t m_sqeArraySize;
+
+	void* m_cqRing;
+	size_t m_cqRingSize;
+	uint32_t* m_cqHead;
+	uint32_t* m_cqTail;
+	uint32_t m_cqMask;
+	io_uring_cqe* m_cqeArray;
+
+protected:
+	int
+	enter(
+		uint_t submitCount,
+		uint_t waitCount,
+		uint_t flags
+	);
+
+public:
+	IoUring();
+
+	~IoUring() {
+		close();
+	}
+
+	bool
+	isOpen() {
+		return m_fd != -1;
+	}
+
+	uint_t
+	getEntryCount() {
+		return m_entryCount;
+	}
+
+	bool
+	open(uint_t entryCount);
+
+	void
+	close();
+
+	io_uring_sqe*
+	getSqe();
+
+	// the kernel may take fewer entries than asked for, so this loops until
+	// all the queued entries are taken; submitCount receives the number of
+	// entries actually submitted (even on errors)
+
+	bool
+	submit(uint_t* submitCount);
+
+	// waits until there are at least waitCount completions in the ring
+
+	bool
+	wait(uint_t waitCount);
+
+	bool
+	getCqe(io_uring_cqe* cqe);
+};
+
+#endif
+
+//..............................................................................
+
+// reads a batch of source files: small files are read into a shared slab with
+// a single batched submission (io_uring where available, pread otherwise);
+// large files are mapped unless mapping is disabled
+
+class SourceReader {
+protected:
+#if (_AXL_OS_POSIX)
+	struct PendingRead {
+		SourceReadRequest* m_request;
+		int m_fd;
+		char* m_p;
+		size_t m_size;
+		bool m_isCompleted;
+	};
+
+	sl::Array<PendingRead> m_pendingReadArray;
+#endif
+
+#if (_LUADOXYXML_IO_URING)
+	enum {
+		RingEntryCount = 64,
+	};
+
+	IoUring m_ring;
+	bool m_isRingFailed;
+	sl::Array<iovec> m_iovecArray;
+#endif
+
+	SourceReaderStats m_stats;
+
+public:
+	bool m_isMappingDisabled; // read large files into the slab, too (POSIX only)
+
+public:
+	SourceReader();
+
+	const SourceReaderStats&
+	getStats() {
+		return m_stats;
+	}
+
+	void
+	read(
+		SourceReadRequest* const* requestArray,
+		size_t count
+	);
+
+#if (_AXL_OS_POSIX)
+protected:
+	void
+	readPendingPread();
+
+	bool
+	readFile(
+		const PendingRead& pendingRead,
+		size_t offset = 0
+	);
+
+	void
+	completePendingRead(
+		PendingRead* pendingRead,
+		bool result
+	);
+
+#	if (_LUADOXYXML_IO_URING)
+	void
+	readPendingUring(SourceSlab* slab);
+#	endif
+#endif
+};
+
+//..............................................................................
@@ -0,0 +1,342 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+
+#include "pch.h"
+#include "SourceWatcher.h"
+
+#if (_AXL_OS_LINUX)
+#	include <sys/inotify.h>
+#	include <sys/stat.h>
+#	include <dirent.h>
+#	include <poll.h>
+#	include <unistd.h>
+#	include <errno.h>
+#endif
+
+//..............................................................................
+
+SourceWatcher::SourceWatcher() {
+	m_fd = -1;
+	m_isRecursive = false;
+}
+
+#if (_AXL_OS_LINUX)
+
+bool
+SourceWatcher::open() {
+	close();
+
+	m_fd = inotify_init1(IN_CLOEXEC);
+	if (m_fd == -1) {
+		err::setErrno(errno);
+		return false;
+	}
+
+	return true;
+}
+
+void
+SourceWatcher::close() {
+	if (m_fd == -1)
+		return;
+
+	::close(m_fd);
+	m_fd = -1;
+	m_dirMap.clear();
+}
+
+bool
+SourceWatcher::addFile(const sl::StringRef& fileName) {
+	size_t i = fileName.reverseFind('/');
+	sl::String path = i != -1 ? fileName.getLeftSubString(i + 1) : sl::StringRef();
+	sl::String name = fileName.getSubString(i + 1); // -1 + 1 = 0
+
+	Dir* dir = addWatch(path);
+	if (!dir)
+		return false;
+
+	dir->m_fileNameSet[name] = true;
+	return true;
+}
+
+bool
+SourceWatcher::addDir(const sl::StringRef& dirName) {
+	sl::String path = dirName;
+	if (path.isEmpty() || path[path.getLength() - 1] != '/')
+		path += '/';
+
+	Dir* dir = addWatch(path);
+	if (!dir)
+		return false;
+
+	watchSourceDir(dir, path, path.getLength());
+	return true;
+}
+
+bool
+SourceWatcher::wait(sl::BoxList<sl::String>* fileNameList) {
+	uint64_t buffer[EventBufferSize / sizeof(uint64_t)]; // aligned for inotify_event
+	sl::StringHashTable<bool> fileNameSet; // saving a file usually takes several events
+	bool isChanged = false;
+	bool isRescanNeeded = false;
+	int timeout = -1;
+
+	fileNameList->clear();
+
+	for (;;) {
+		pollfd pfd;
+		pfd.fd = m_fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+
+		int result = ::poll(&pfd, 1, timeout);
+		if (result < 0) {
+			if (errno == EINTR)
+				continue;
+
+			err::setErrno(errno);
+			return false;
+		}
+
+		if (!result) { // no more events within the debounce timeout
+			if (isRescanNeeded)
+				fileNameList->clear();
+
+			return true;
+		}
+
+		ssize_t size = ::read(m_fd, buffer, sizeof(buffer));
+		if (size < 0) {
+			if (errno == EINTR)
+				continue;
+
+			err::setErrno(errno);
+			return false;
+		}
+
+		const char* p = (char*)buffer;
+		const char* end = p + size;
+		while (p < end) {
+			const inotify_event* event = (const inotify_event*)p;
+			p += sizeof(inotify_event) + event->len;
+
+			if (processEvent(event, fileNameList, &fileNameSet, &isRescanNeeded))
+				isChanged = true;
+		}
+
+		if (isChanged)
+			timeout = DebounceTimeout;
+	}
+}
+
+SourceWatcher::Dir*
+SourceWatcher::addWatch(const sl::String& path) {
+	int wd = inotify_add_watch(
+		m_fd,
+		path.isEmpty() ? "." : path.sz(),
+		IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR
+	);
+
+	if (wd == -1) {
+		err::setFormatStringError("can't watch %s: %s", path.isEmpty() ? "." : path.sz(), strerror(errno));
+		return NULL;
+	}
+
+	sl::SimpleHashTableIterator<int, Dir> it = m_dirMap.visit(wd);
+	if (it->m_value.m_path.isEmpty()) // otherwise, it's the same dir via a different path
+		it->m_value.m_path = path;
+
+	return &it->m_value;
+}
+
+size_t
+SourceWatcher::watchSourceDir(
+	Dir* dir,
+	const sl::String& path,
+	size_t rootLength,
+	sl::BoxList<sl::String>* fileNameList,
+	sl::StringHashTable<bool>* fileNameSet
+) {
+	dir->m_path = path; // names of explicitly listed files don't depend on it
+	dir->m_rootLength = rootLength;
+	dir->m_isSourceDir = true;
+
+	DIR* h = opendir(path.sz());
+	if (!h)
+		return 0;
+
+	size_t fileCount = 0;
+
+	struct dirent* entry;
+	while ((entry = readdir(h))) {
+		const char* name = entry->d_name;
+		if (name[0] == '.' && (!name[1] || (name[1] == '.' && !name[2])))
+			continue;
+
+		sl::String subPath = path + name;
+
+		struct stat st;
+		if (lstat(subPath.sz(), &st) != 0)
+			continue;
+
+		if (!S_ISDIR(st.st_mode)) {
+			if (!isSourceFile(dir, name))
+				continue;
+
+			fileCount++;
+
+			if (fileNameList && fileNameSet->addIfNotExists(subPath, true))
+				fileNameList->insertTail(subPath);
+
+			continue;
+		}
+
+		// like the scanner, don't follow symlinks to directories
+
+		if (!m_isRecursive || isExcludedDir(dir, name))
+			continue;
+
+		subPath += '/';
+
+		Dir* subdir = addWatch(subPath);
+		if (subdir)
+			fileCount += watchSourceDir(subdir, subPath, rootLength, fileNameList, fileNameSet);
+		else
+			printf("warning: %s\n", err::getLastErrorDescription().sz());
+	}
+
+	closedir(h);
+	return fileCount;
+}
+
+bool
+SourceWatcher::processEvent(
+	const inotify_event* event,
+	sl::BoxList<sl::String>* fileNameList,
+	sl::StringHashTable<bool>* fileNameSet,
+	bool* isRescanNeeded
+) {
+	if (event->mask & IN_Q_OVERFLOW) { // events were lost, so anything could change
+		*isRescanNeeded = true;
+		return true;
+	}
+
+	sl::SimpleHashTableIterator<int, Dir> it = m_dirMap.find(event->wd);
+	if (!it)
+		return false;
+
+	if (event->mask & IN_IGNORED) { // the dir itself is gone
+		m_dirMap.erase(it);
+		return false;
+	}
+
+	if (!event->len)
+		return false;
+
+	Dir* dir = &it->m_value;
+	sl::StringRef name = event->name; // zero-padded
+
+	if (!(event->mask & IN_ISDIR)) {
+		if (!isSourceFile(dir, name))
+			return false;
+
+		sl::String path = dir->m_path + name;
+		if (fileNameSet->addIfNotExists(path, true))
+			fileNameList->insertTail(path);
+
+		return true;
+	}
+
+	// new dirs only matter if they bring in source files (e.g. when moved
+	// in); our own temporary output dirs are created empty
+
+	if (!dir->m_isSourceDir || !m_isRecursive || isExcludedDir(dir, name))
+		return false;
+
+	if (event->mask & IN_MOVED_FROM) { // files inside are not reported
+		*isRescanNeeded = true;
+		return true;
+	}
+
+	if (!(event->mask & (IN_CREATE | IN_MOVED_TO)))
+		return false;
+
+	sl::String path = dir->m_path + name;
+	path += '/';
+
+	size_t rootLength = dir->m_rootLength;
+	Dir* subdir = addWatch(path);
+	return subdir && watchSourceDir(subdir, path, rootLength, fileNameList, fileNameSet) != 0;
+}
+
+bool
+SourceWatcher::isSourceFile(
+	const Dir* dir,
+	const sl::StringRef& name
+) {
+	if (dir->m_fileNameSet.find(name))
+		return true;
+
+	if (!dir->m_isSourceDir)
+		return false;
+
+	sl::String path = dir->m_path + name;
+	sl::StringRef relativePath = path.getSubString(dir->m_rootLength);
+
+	return
+		(m_excludeSet.isEmpty() || !m_excludeSet.match(relativePath, name, false)) &&
+		m_includeSet.match(relativePath, name, false);
+}
+
+bool
+SourceWatcher::isExcludedDir(
+	const Dir* dir,
+	const sl::StringRef& name
+) {
+	if (m_excludeSet.isEmpty())
+		return false;
+
+	sl::String path = dir->m_path + name;
+	sl::StringRef relativePath = path.getSubString(dir->m_rootLength);
+	return m_excludeSet.match(relativePath, name, true);
+}
+
+#else
+
+bool
+SourceWatcher::open() {
+	err::setFormatStringError("watch mode is not supported on this platform");
+	return false;
+}
+
+void
+SourceWatcher::close() {
+}
+
+bool
+SourceWatcher::addFile(const sl::StringRef& fileName) {
+	return false;
+}
+
+bool
+SourceWatcher::addDir(const sl::StringRef& dirName) {
+	return false;
+}
+
+bool
+SourceWatcher::wait(sl::BoxList<sl::String>* fileNameList) {
+	return false;
+}
+
+#endif
+
+//..............................................................................
@@ -0,0 +1,119 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+
+#pragma once
+
+#include "Glob.h"
+
+struct inotify_event;
+
+//..............................................................................
+
+// watches source files and directories for modifications (via inotify, so
+// Linux only). directories rather than files are watched: editors often save
+// by writing a new file and renaming it over the original one
+
+class SourceWatcher {
+protected:
+	enum {
+		EventBufferSize = 16 * 1024,
+		DebounceTimeout = 50, // ms; editors may touch a file several times per save
+	};
+
+	struct Dir {
+		sl::String m_path; // empty or ends with a slash
+		size_t m_rootLength;
+		bool m_isSourceDir;
+		sl::StringHashTable<bool> m_fileNameSet; // explicitly listed files in this dir
+
+		Dir() {
+			m_rootLength = 0;
+			m_isSourceDir = false;
+		}
+	};
+
+protected:
+	int m_fd;
+	sl::SimpleHashTable<int, Dir> m_dirMap; // by watch descriptor
+
+public:
+	GlobSet m_includeSet;
+	GlobSet m_excludeSet;
+	bool m_isRecursive;
+
+public:
+	SourceWatcher();
+
+	~SourceWatcher() {
+		close();
+	}
+
+	bool
+	open();
+
+	void
+	close();
+
+	bool
+	addFile(const sl::StringRef& fileName);
+
+	bool
+	addDir(const sl::StringRef& dirName);
+
+	// blocks until relevant files are modified, created or removed, and then
+	// until things settle down; source files in new dirs are listed, too. the
+	// list is empty if events were lost or a dir was moved away -- anything
+	// may have changed then
+
+	bool
+	wait(sl::BoxList<sl::String>* fileNameList);
+
+protected:
+	Dir*
+	addWatch(const sl::String& path);
+
+	// returns the number of source files found (in subdirs, too); these are
+	// also added to the list, if any
+
+	size_t
+	watchSourceDir(
+		Dir* dir,
+		const sl::String& path,
+		size_t rootLength,
+		sl::BoxList<sl::String>* fileNameList = NULL,
+		sl::StringHashTable<bool>* fileNameSet = NULL
+	);
+
+	// returns true if the event may affect the module
+
+	bool
+	processEvent(
+		const inotify_event* event,
+		sl::BoxList<sl::String>* fileNameList,
+		sl::StringHashTable<bool>* fileNameSet,
+		bool* isRescanNeeded
+	);
+
+	bool
+	isSourceFile(
+		const Dir* dir,
+		const sl::StringRef& name
+	);
+
+	bool
+	isExcludedDir(
+		const Dir* dir,
+		const sl::StringRef& name
+	);
+};
+
+//..............................................................................
@@ -0,0 +1,413 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+
+#include "pch.h"
+#include "TextScan.h"
+
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#	define _TEXT_SCAN_SSE2 1
+#	include <emmintrin.h>
+#else
+#	define _TEXT_SCAN_SSE2 0
+#endif
+
+//..............................................................................
+
+inline
+bool
+isWhitespace(char c) {
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+size_t
+findWhitespaceEnd_scalar(
+	const char* p,
+	size_t length
+) {
+	size_t i = 0;
+	while (i < length && isWhitespace(p[i]))
+		i++;
+
+	return i;
+}
+
+size_t
+findLineEnd_scalar(
+	const char* p,
+	size_t length
+) {
+	const char* end = (const char*)memchr(p, '\n', length);
+	return end ? end - p : length;
+}
+
+inline
+bool
+isLongBracketEnd(
+	const char* p,
+	size_t level
+) {
+	ASSERT(p[0] == ']');
+
+	for (size_t i = 1; i <= level; i++)
+		if (p[i] != '=')
+			return false;
+
+	return p[level + 1] == ']';
+}
+
+size_t
+findLongBracketEnd_scalar(
+	const char* p,
+	size_t length,
+	size_t level
+) {
+	size_t bracketLength = level + 2;
+	if (length < bracketLength)
+		return -1;
+
+	const char* p0 = p;
+	const char* end = p + length - bracketLength + 1; // last possible start + 1
+	while (p < end) {
+		p = (const char*)memchr(p, ']', end - p);
+		if (!p)
+			break;
+
+		if (isLongBracketEnd(p, level))
+			return p - p0;
+
+		p++;
+	}
+
+	return -1;
+}
+
+size_t
+countLines_scalar(
+	const char* p,
+	size_t length,
+	size_t* lastLineOffset
+) {
+	size_t count = 0;
+
+	for (size_t i = 0; i < length; i++)
+		if (p[i] == '\n') {
+			count++;
+			*lastLineOffset = i + 1;
+		}
+
+	return count;
+}
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+const ScanFuncTable g_scalarScanFuncTable = {
+	findWhitespaceEnd_scalar,
+	findLineEnd_scalar,
+	findLongBracketEnd_scalar,
+	countLines_scalar,
+};
+
+//..............................................................................
+
+#if (_TEXT_SCAN_SSE2)
+
+inline
+uint_t
+getLoBitIdx(uint_t mask) { // mask != 0
+	ASSERT(mask);
+#	if (_AXL_CPP_MSC)
+	unsigned long idx;
+	_BitScanForward(&idx, mask);
+	return idx;
+#	else
+	return __builtin_ctz(mask);
+#	endif
+}
+
+inline
+uint_t
+getHiBitIdx(uint_t mask) { // mask != 0
+	ASSERT(mask);
+#	if (_AXL_CPP_MSC)
+	unsigned long idx;
+	_BitScanReverse(&idx, mask);
+	return idx;
+#	else
+	return 31 - __builtin_clz(mask);
+#	endif
+}
+
+inline
+uint_t
+getBitCount(uint_t mask) {
+#	if (_AXL_CPP_MSC)
+	return __popcnt(mask);
+#	else
+	return __builtin_popcount(mask);
+#	endif
+}
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+size_t
+findWhitespaceEnd_sse2(
+	const char* p,
+	size_t length
+) {
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i tab = _mm_set1_epi8('\t');
+	const __m128i cr = _mm_set1_epi8('\r');
+	const __m128i lf = _mm_set1_epi8('\n');
+
+	size_t i = 0;
+	for (; length - i >= 16; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+		__m128i match = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+			_mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf))
+		);
+
+		uint_t mask = _mm_movemask_epi8(match) ^ 0xffff;
+		if (mask)
+			return i + getLoBitIdx(mask);
+	}
+
+	return i + findWhitespaceEnd_scalar(p + i, length - i);
+}
+
+size_t
+findLineEnd_sse2(
+	const char* p,
+	size_t length
+) {
+	const __m128i lf = _mm_set1_epi8('\n');
+
+	size_t i = 0;
+	for (; length - i >= 16; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+		uint_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, lf));
+		if (mask)
+			return i + getLoBitIdx(mask);
+	}
+
+	return i + findLineEnd_scalar(p + i, length - i);
+}
+
+size_t
+findLongBracketEnd_sse2(
+	const char* p,
+	size_t length,
+	size_t level
+) {
+	const __m128i bracket = _mm_set1_epi8(']');
+
+	// compare each 16-byte block and the same block shifted by level + 1
+	// chars; candidates of levels above 0 must also have '=' chars in between
+
+	size_t distance = level + 1;
+	size_t i = 0;
+	for (; length - i >= 16 + distance; i += 16) {
+		__m128i v0 = _mm_loadu_si128((const __m128i*)(p + i));
+		__m128i v1 = _mm_loadu_si128((const __m128i*)(p + i + distance));
+		uint_t mask = _mm_movemask_epi8(_mm_and_si128(
+			_mm_cmpeq_epi8(v0, bracket),
+			_mm_cmpeq_epi8(v1, bracket)
+		));
+
+		while (mask) {
+			uint_t idx = getLoBitIdx(mask);
+			if (isLongBracketEnd(p + i + idx, level))
+				return i + idx;
+
+			mask &= mask - 1;
+		}
+	}
+
+	size_t offset = findLongBracketEnd_scalar(p + i, length - i, level);
+	return offset != -1 ? i + offset : -1;
+}
+
+size_t
+countLines_sse2(
+	const char* p,
+	size_t length,
+	size_t* lastLineOffset
+) {
+	const __m128i lf = _mm_set1_epi8('\n');
+
+	size_t count = 0;
+	size_t i = 0;
+	for (; length - i >= 16; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+		uint_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, lf));
+		if (mask) {
+			count += getBitCount(mask);
+			*lastLineOffset = i + getHiBitIdx(mask) + 1;
+		}
+	}
+
+	size_t tailLastLineOffset;
+	size_t tailCount = countLines_scalar(p + i, length - i, &tailLastLineOffset);
+	if (tailCount) {
+		count += tailCount;
+		*lastLineOffset = i + tailLastLineOffset;
+	}
+
+	return count;
+}
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+const ScanFuncTable g_vectorScanFuncTable = {
+	findWhitespaceEnd_sse2,
+	findLineEnd_sse2,
+	findLongBracketEnd_sse2,
+	countLines_sse2,
+};
+
+#else
+
+const ScanFuncTable g_vectorScanFuncTable = g_scalarScanFuncTable;
+
+#endif
+
+//..............................................................................
+
+// returns the level of a long bracket at p ('[' '='* '['), or -1
+
+size_t
+getLongBracketLevel(
+	const char* p,
+	const char* end
+) {
+	ASSERT(p < end && *p == '[');
+
+	const char* p0 = p;
+	for (p++; p < end && *p == '='; p++)
+		;
+
+	return p < end && *p == '[' ? p - p0 - 1 : -1;
+}
+
+// mirrors lit_sq / lit_dq in Lexer.rl: ends at the closing quote, at a
+// newline or at a backslash which doesn't escape anything
+
+const char*
+skipQuotedString(
+	const char* p,
+	const char* end
+) {
+	char quote = *p++;
+
+	while (p < end) {
+		char c = *p++;
+		if (c == quote || c == '\n')
+			break;
+
+		if (c == '\\') {
+			if (p >= end || *p == '\n')
+				break;
+
+			p++;
+		}
+	}
+
+	return p;
+}
+
+size_t
+findDataTableEnd(
+	const char* p,
+	size_t length
+) {
+	ASSERT(length && *p == '{');
+
+	const char* p0 = p;
+	const char* end = p + length;
+	size_t level = 0;
+
+	while (p < end) {
+		size_t bracketLevel;
+		size_t offset;
+
+		switch (*p) {
+		case '{':
+			level++;
+			p++;
+			break;
+
+		case '}':
+			if (!--level)
+				return p - p0;
+
+			p++;
+			break;
+
+		case '"':
+		case '\'':
+			p = skipQuotedString(p, end);
+			break;
+
+		case '[':
+			bracketLevel = getLongBracketLevel(p, end);
+			if (bracketLevel == -1) {
+				p++;
+				break;
+			}
+
+			p += bracketLevel + 2;
+			offset = g_vectorScanFuncTable.m_findLongBracketEnd(p, end - p, bracketLevel);
+			if (offset == -1)
+				return -1;
+
+			p += offset + bracketLevel + 2;
+			break;
+
+		case '-':
+			if (end - p < 2 || p[1] != '-') {
+				p++;
+				break;
+			}
+
+			p += 2;
+			if (p < end && *p == '!')
+				return -1;
+
+			if (p < end && *p == '[') {
+				bracketLevel = getLongBracketLevel(p, end);
+				if (bracketLevel != -1) {
+					const char* body = p + bracketLevel + 2;
+					if (body < end && *body == '!')
+						return -1;
+
+					offset = g_vectorScanFuncTable.m_findLongBracketEnd(body, end - body, bracketLevel);
+					if (offset != -1) {
+						p = body + offset + bracketLevel + 2;
+						break;
+					}
+				}
+			}
+
+			// line comments (and unterminated long ones)
+
+			p += g_vectorScanFuncTable.m_findLineEnd(p, end - p);
+			break;
+
+		default:
+			p++;
+		}
+	}
+
+	return -1;
+}
+
+//..............................................................................
@@ -0,0 +1,73 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+
+#pragma once
+
+//..............................................................................
+
+// bulk scans used by the lexer to skip whitespace runs and comment bodies
+// without stepping through the DFA byte by byte. all functions take a buffer
+// and its length and return offsets; the vectorized table uses SSE2 where
+// available and falls back to the scalar implementations otherwise
+
+struct ScanFuncTable {
+	// offset of the first char which is not ' ', '\t', '\r' or '\n'
+	size_t
+	(*m_findWhitespaceEnd)(
+		const char* p,
+		size_t length
+	);
+
+	// offset of the first '\n' (or length)
+	size_t
+	(*m_findLineEnd)(
+		const char* p,
+		size_t length
+	);
+
+	// offset of the first closing long bracket of the level, i.e. ']' followed
+	// by <level> '=' chars and another ']' (or -1)
+	size_t
+	(*m_findLongBracketEnd)(
+		const char* p,
+		size_t length,
+		size_t level
+	);
+
+	// number of '\n' chars; the offset of the char following the last
+	// one is stored in *lastLineOffset (untouched if there are none)
+	size_t
+	(*m_countLines)(
+		const char* p,
+		size_t length,
+		size_t* lastLineOffset
+	);
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+extern const ScanFuncTable g_scalarScanFuncTable;
+extern const ScanFuncTable g_vectorScanFuncTable;
+
+//..............................................................................
+
+// p must point to the '{' of a table constructor; returns the offset of the
+// matching '}' (strings and comments are skipped), or -1 if the constructor
+// is not closed or contains doxy comments
+
+size_t
+findDataTableEnd(
+	const char* p,
+	size_t length
+);
+
+//..............................................................................
@@ -0,0 +1,67 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "XmlWriter.h"
+
+#include <errno.h>
+
+//..............................................................................
+
+bool
+XmlWriter::open(const sl::StringRef& fileName) {
+	close();
+
+	m_file = fopen(fileName.sz(), "wb");
+	if (!m_file) {
+		err::setErrno(errno);
+		return false;
+	}
+
+	m_fileBuffer = new OutputBuffer(m_file);
+	m_fileName = fileName;
+	return true;
+}
+
+bool
+XmlWriter::close() {
+	if (!m_file)
+		return true;
+
+	bool result = m_fileBuffer->flush() && !ferror(m_file);
+	delete m_fileBuffer;
+	m_fileBuffer = NULL;
+
+	result = fclose(m_file) == 0 && result;
+	m_file = NULL;
+
+	if (!result) {
+		err::setFormatStringError("error writing %s", m_fileName.sz());
+		return false;
+	}
+
+	return true;
+}
+
+void
+XmlWriter::format(
+	const char* formatString,
+	...
+) {
+	va_list va;
+	va_start(va, formatString);
+
+	m_fileBuffer->format_va(formatString, va);
+
+	va_end(va);
+}
+
+//..............................................................................
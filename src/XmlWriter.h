@@ -0,0 +1,63 @@
+//..............................................................................
+//
+//  This file is part of the LuaDoxyXML toolkit.
+//
+//  LuaDoxyXML is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/luadoxyxml/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+#include "OutputBuffer.h"
+
+//..............................................................................
+
+// XML goes straight into a buffered file (the global compound included, see
+// Module::generateDocumentation)
+
+class XmlWriter {
+protected:
+	FILE* m_file;
+	OutputBuffer* m_fileBuffer;
+	sl::String m_fileName;
+
+public:
+	XmlWriter() {
+		m_file = NULL;
+		m_fileBuffer = NULL;
+	}
+
+	~XmlWriter() {
+		close();
+	}
+
+	bool
+	open(const sl::StringRef& fileName);
+
+	bool
+	close();
+
+	void
+	write(
+		const void* p,
+		size_t size
+	) {
+		m_fileBuffer->write(p, size);
+	}
+
+	void
+	print(const sl::StringRef& string) {
+		write(string.cp(), string.getLength());
+	}
+
+	void
+	format(
+		const char* formatString,
+		...
+	);
+};
+
+//..............................................................................
@@ -12,8 +12,15 @@
 #include "pch.h"
 #include "CmdLine.h"
 #include "DoxyHost.h"
+#include "FilterServer.h"
+#include "Module.h"
+#include "ParseMgr.h"
+#include "ParseCache.h"
+#include "OutputSync.h"
+#include "DependencyGraph.h"
+#include "SourceDirScanner.h"
+#include "SourceWatcher.h"
 #include "Lexer.h"
-#include "Parser.llk.h"
 #include "version.h"
 
 #define _PRINT_USAGE_IF_NO_ARGUMENTS 1
@@ -41,145 +48,648 @@ printUsage() {
 	printf("Usage: luadoxyxml [options] <source.lua>...\n%s", helpString.sz());
 }
 
+// compared to full token positions: values used to keep positions of the
+// first and the last tokens plus the source string, and items -- a position
+
+size_t
+calcCompactSpanSavedSize(const Unit* unit) {
+	size_t itemSavedSize = sizeof(Token::Pos) - sizeof(uint32_t);
+	size_t valueSavedSize = 2 * sizeof(Token::Pos) + sizeof(sl::StringRef) - sizeof(SourceSpan);
+	size_t size = 0;
+
+	sl::ConstIterator<ModuleItem> it = unit->m_itemList.getHead();
+	for (; it; it++) {
+		size += itemSavedSize;
+		if (it->m_itemKind != ModuleItemKind_Function)
+			size += valueSavedSize * 2; // m_index and m_initializer
+	}
+
+	return size;
+}
+
 bool
-parseFile(
-	const sl::StringRef& fileName,
-	Module* module
+initSourceFilter(
+	CmdLine* cmdLine,
+	GlobSet* includeSet,
+	GlobSet* excludeSet
 ) {
-	io::SimpleMappedFile file;
+	bool result;
 
-	bool result = file.open(fileName, io::FileFlag_ReadOnly);
-	if (!result)
-		return false;
+	if (cmdLine->m_includeList.isEmpty()) {
+		includeSet->add("*.lua");
+		includeSet->add("*.dox");
+	}
 
-	Lexer lexer;
-	Parser parser(module);
-	((DoxyHost*)module->getDoxyHost())->setup(module, &parser);
+	sl::ConstBoxIterator<sl::String> it = cmdLine->m_includeList.getHead();
+	for (; it; it++) {
+		result = includeSet->add(*it);
+		if (!result)
+			return false;
+	}
 
-	sl::String source((const char*)file.p(), file.getMappingSize());
-	lexer.create(source);
-	parser.create(fileName, SymbolKind_block);
-	module->addSource(source); // need to keep sources alive since we use StringRef's in module items
+	it = cmdLine->m_excludeList.getHead();
+	for (; it; it++) {
+		result = excludeSet->add(*it);
+		if (!result)
+			return false;
+	}
 
-	bool isEof = false;
-	do {
-		const Token* token = lexer.getToken();
+	return true;
+}
 
-		sl::StringRef comment;
-		ModuleItem* lastDeclaredItem;
+// everything on the command line which changes the generated XML: item ranks
+// follow the order of input files and source dirs (and the filters applied
+// to the latter)
 
-		switch (token->m_token) {
-		case TokenKind_DoxyComment_sl:
-		case TokenKind_DoxyComment_ml:
-			comment = token->m_data.m_string;
+void
+addDependencyGraphOptions(
+	CmdLine* cmdLine,
+	DependencyGraph* dependencyGraph
+) {
+	if (cmdLine->m_flags & CmdLineFlag_DocumentedOnly)
+		dependencyGraph->addOption("--documented-only");
 
-			lastDeclaredItem = NULL;
+	if (cmdLine->m_flags & CmdLineFlag_DataTables)
+		dependencyGraph->addOption("--data-tables");
 
-			if (!comment.isEmpty() && comment[0] == '<') {
-				lastDeclaredItem = parser.getLastDeclaredItem();
-				comment = comment.getSubString(1);
-			}
+	if (cmdLine->m_flags & CmdLineFlag_Recursive)
+		dependencyGraph->addOption("-R");
 
-			parser.addDoxyComment(
-				comment,
-				token->m_pos,
-				token->m_tokenKind == TokenKind_DoxyComment_sl,
-				lastDeclaredItem
-			);
+	sl::ConstBoxIterator<sl::String> it = cmdLine->m_inputFileNameList.getHead();
+	for (; it; it++)
+		dependencyGraph->addOption(*it);
 
-			lexer.nextToken();
-			break;
+	it = cmdLine->m_sourceDirList.getHead();
+	for (; it; it++)
+		dependencyGraph->addOption("-S" + *it);
 
-		case TokenKind_Eof:
-			isEof = true;
-			// fall through; EOF token must be parsed
+	it = cmdLine->m_includeList.getHead();
+	for (; it; it++)
+		dependencyGraph->addOption("--include=" + *it);
 
-		default:
-			result = parser.consumeToken(lexer.takeToken());
-			if (!result)
-				return false;
+	it = cmdLine->m_excludeList.getHead();
+	for (; it; it++)
+		dependencyGraph->addOption("--exclude=" + *it);
+}
+
+// explicitly listed files are bound first, in the command-line order; then
+// files from each source directory, sorted by path
+
+bool
+parseSources(
+	CmdLine* cmdLine,
+	ParseMgr* parseMgr
+) {
+	bool result;
+
+	size_t rank = 0;
+
+	sl::ConstBoxIterator<sl::String> it = cmdLine->m_inputFileNameList.getHead();
+	for (; it; it++)
+		parseMgr->addFile(*it, rank++);
+
+	if (cmdLine->m_sourceDirList.isEmpty()) {
+		result = parseMgr->parse(cmdLine->m_jobCount);
+	} else {
+		SourceDirScanner scanner(parseMgr);
+		scanner.m_isRecursive = (cmdLine->m_flags & CmdLineFlag_Recursive) != 0;
+
+		result = initSourceFilter(cmdLine, &scanner.m_includeSet, &scanner.m_excludeSet);
+		if (!result)
+			return false;
+
+		it = cmdLine->m_sourceDirList.getHead();
+		for (; it; it++)
+			scanner.addDir(*it, rank++);
+
+		// parse files while still scanning
+
+		parseMgr->start(cmdLine->m_jobCount);
+		scanner.scan(cmdLine->m_jobCount);
+		result = parseMgr->finish();
+	}
+
+	return result;
+}
+
+// the rank parseSources would give to a source file
+
+size_t
+getSourceFileRank(
+	CmdLine* cmdLine,
+	const sl::StringRef& fileName
+) {
+	size_t rank = 0;
+
+	sl::ConstBoxIterator<sl::String> it = cmdLine->m_inputFileNameList.getHead();
+	for (; it; it++, rank++)
+		if (*it == fileName)
+			return rank;
+
+	it = cmdLine->m_sourceDirList.getHead();
+	for (; it; it++, rank++) {
+		sl::String dir = *it;
+		if (dir.isEmpty() || dir[dir.getLength() - 1] != '/')
+			dir += '/';
+
+		if (fileName.isPrefix(dir))
+			return rank;
+	}
+
+	return rank;
+}
+
+// binds pending methods and generates the output of a parsed module
+
+bool
+generate(
+	CmdLine* cmdLine,
+	Module* module,
+	ParseMgr* parseMgr,
+	ParseCache* parseCache,
+	bool isVerbose
+) {
+	bool result;
+
+	if (cmdLine->m_flags & CmdLineFlag_Stats) {
+		const SourceReaderStats& stats = parseMgr->getSourceReaderStats();
+		fprintf(
+			stderr,
+			"Source files: %d (mapped: %d, io_uring: %d, pread: %d)\n",
+			(int)parseMgr->getFileCount(),
+			(int)stats.m_mappedFileCount,
+			(int)stats.m_uringFileCount,
+			(int)stats.m_preadFileCount
+		);
+
+		size_t objectCount = 0;
+		size_t blockCount = 0;
+		size_t spanSavedSize = 0;
+		size_t lineTableSize = 0;
+		size_t tokenCount = 0;
+		size_t skippedTokenCount = 0;
+
+		sl::ConstIterator<Unit> unitIt = module->getUnitList().getHead();
+		for (; unitIt; unitIt++) {
+			objectCount += unitIt->m_arena.getAllocCount();
+			blockCount += unitIt->m_arena.getBlockCount();
+			spanSavedSize += calcCompactSpanSavedSize(*unitIt);
+			lineTableSize += unitIt->m_lineOffsetArray.getCount() * sizeof(uint32_t);
+			tokenCount += unitIt->m_tokenCount;
+			skippedTokenCount += unitIt->m_skippedTokenCount;
 		}
-	} while (!isEof);
+
+		fprintf(stderr, "Items and tables: %d (in %d arena blocks)\n", (int)objectCount, (int)blockCount);
+		fprintf(
+			stderr,
+			"Source spans: %d KB saved (line tables: %d KB)\n",
+			(int)(spanSavedSize / 1024),
+			(int)(lineTableSize / 1024)
+		);
+
+		fprintf(
+			stderr,
+			"Tokens: %d, %d skipped in function bodies and data tables\n",
+			(int)tokenCount,
+			(int)skippedTokenCount
+		);
+	}
+
+	if (parseCache->isOpen() && (isVerbose || (cmdLine->m_flags & CmdLineFlag_Stats)))
+		fprintf(
+			isVerbose ? stdout : stderr,
+			"Parse cache: %d hit(s), %d miss(es)\n",
+			(int)parseCache->getHitCount(),
+			(int)parseCache->getMissCount()
+		);
+
+	// in filter mode, parent tables of methods are often declared in other files
+
+	module->bindPendingMethods(!(cmdLine->m_flags & CmdLineFlag_DoxygenFilter));
+
+	if (cmdLine->m_flags & CmdLineFlag_DoxygenFilter)
+		module->finishDoxygenFilterOutput();
+
+	if (cmdLine->m_outputFileName.isEmpty())
+		return true;
+
+	sl::String outputFileName = io::getFileName(cmdLine->m_outputFileName);
+	sl::String outputDir = io::getDir(cmdLine->m_outputFileName);
+
+	module->m_compoundThreadCount = cmdLine->m_jobCount;
+
+	DependencyGraph dependencyGraph;
+	if (cmdLine->m_flags & CmdLineFlag_Incremental) {
+		addDependencyGraphOptions(cmdLine, &dependencyGraph);
+		dependencyGraph.load(outputDir);
+		dependencyGraph.addSourceFiles(module);
+		module->m_dependencyGraph = &dependencyGraph;
+	}
+
+	if (!(cmdLine->m_flags & CmdLineFlag_WriteIfChanged)) {
+		result = module->generateDocumentation(outputDir, outputFileName);
+		if (!result)
+			return false;
+	} else {
+		sl::String stagingDir = createStagingDir(outputDir);
+		if (stagingDir.isEmpty())
+			return false;
+
+		result = module->generateDocumentation(stagingDir, outputFileName);
+		if (!result) {
+			removeStagingDir(stagingDir);
+			return false;
+		}
+
+		OutputSyncStats syncStats;
+		result = syncOutputDir(stagingDir, outputDir, &syncStats);
+		if (!result)
+			return false;
+
+		if (cmdLine->m_flags & CmdLineFlag_Stats)
+			fprintf(
+				stderr,
+				"Output files: %d written, %d unchanged\n",
+				(int)syncStats.m_writtenFileCount,
+				(int)syncStats.m_unchangedFileCount
+			);
+	}
+
+	if (cmdLine->m_flags & CmdLineFlag_Incremental) {
+		result = dependencyGraph.save();
+		if (!result)
+			return false;
+
+		if (cmdLine->m_flags & CmdLineFlag_Stats)
+			fprintf(
+				stderr,
+				"Compounds: %d regenerated, %d up to date\n",
+				(int)dependencyGraph.getDirtyCount(),
+				(int)(dependencyGraph.getCompoundCount() - dependencyGraph.getDirtyCount())
+			);
+	}
 
 	return true;
 }
 
 bool
-run(CmdLine* cmdLine) {
-	static char luaSuffix[] = ".lua";
-	static char doxSuffix[] = ".dox";
+build(
+	CmdLine* cmdLine,
+	ParseCache* parseCache,
+	bool isVerbose
+) {
+	DoxyHost doxyHost;
+	Module module(&doxyHost);
+	doxyHost.setup(&module);
+	module.m_isDataTableMode = (cmdLine->m_flags & CmdLineFlag_DataTables) != 0;
+	module.m_isDocumentedOnly = // must be set before binding
+		(cmdLine->m_flags & (CmdLineFlag_DocumentedOnly | CmdLineFlag_DoxygenFilter)) == CmdLineFlag_DocumentedOnly;
 
-	enum {
-		SuffixLength = lengthof(luaSuffix)
-	};
+	OutputBuffer doxygenFilterOutput(stdout);
+	if (cmdLine->m_flags & CmdLineFlag_DoxygenFilter)
+		module.startDoxygenFilterOutput(&doxygenFilterOutput);
+
+	ParseMgr parseMgr(&module);
+	parseMgr.m_isVerbose = isVerbose;
+
+	if (parseCache->isOpen())
+		parseMgr.m_parseCache = parseCache;
+
+	return
+		parseSources(cmdLine, &parseMgr) &&
+		generate(cmdLine, &module, &parseMgr, parseCache, isVerbose);
+}
+
+// units of all the source files are kept in memory, so after a modification,
+// only the modified (or created) files are read and parsed again; the module
+// is then bound anew from the event logs of all units (see Module::unbind),
+// and only the compounds affected by the modification are regenerated. if
+// inotify events were lost, everything is scanned and parsed from scratch
 
+bool
+watch(
+	CmdLine* cmdLine,
+	ParseCache* parseCache
+) {
 	bool result;
 
-	DoxyHost doxyHost;
-	Module module(&doxyHost);
+	SourceWatcher watcher;
+	watcher.m_isRecursive = (cmdLine->m_flags & CmdLineFlag_Recursive) != 0;
 
-	sl::ConstBoxIterator<sl::String> it = cmdLine->m_inputFileNameList.getHead();
-	for (; it; it++) {
-		const sl::String& fileName = *it;
+	result =
+		watcher.open() &&
+		initSourceFilter(cmdLine, &watcher.m_includeSet, &watcher.m_excludeSet);
 
-		if (!(cmdLine->m_flags & CmdLineFlag_DoxygenFilter))
-			printf("Parsing %s...\n", fileName.sz());
+	if (!result)
+		return false;
 
-		result = parseFile(fileName, &module);
+	sl::ConstBoxIterator<sl::String> it = cmdLine->m_inputFileNameList.getHead();
+	for (; it; it++) {
+		result = watcher.addFile(*it);
 		if (!result)
 			return false;
 	}
 
 	it = cmdLine->m_sourceDirList.getHead();
 	for (; it; it++) {
-		sl::String dir = *it;
-		if (dir.isEmpty())
-			continue;
+		result = watcher.addDir(*it);
+		if (!result)
+			return false;
+	}
 
-		if (dir[dir.getLength() - 1])
-			dir += '/';
+	DoxyHost doxyHost;
+	Module module(&doxyHost);
+	doxyHost.setup(&module);
+	module.m_isDataTableMode = (cmdLine->m_flags & CmdLineFlag_DataTables) != 0;
+	module.m_isDocumentedOnly = // must be set before binding
+		(cmdLine->m_flags & (CmdLineFlag_DocumentedOnly | CmdLineFlag_DoxygenFilter)) == CmdLineFlag_DocumentedOnly;
+
+	ParseMgr parseMgr(&module);
+	parseMgr.m_isMappingDisabled = true; // see SourceFile
+
+	if (parseCache->isOpen())
+		parseMgr.m_parseCache = parseCache;
+
+	// errors don't stop watching -- the next save will likely fix them
+
+	sl::BoxList<sl::String> fileNameList;
+	bool isVerbose = true;
+	bool isRescanNeeded = true;
+
+	for (;;) {
+		uint64_t timestamp = sys::getTimestamp();
+
+		parseMgr.m_isVerbose = isVerbose;
+		parseMgr.resetStats();
+		parseCache->resetStats();
 
-		io::FileEnumerator fileEnum;
-		bool result = fileEnum.openDir(dir);
+		if (isRescanNeeded) {
+			module.clear();
+			parseMgr.clear();
+			result = parseSources(cmdLine, &parseMgr);
+			isRescanNeeded = !result; // some units may be left unparsed
+		} else {
+			it = fileNameList.getHead();
+			for (; it; it++)
+				parseMgr.updateFile(*it, getSourceFileRank(cmdLine, *it));
+
+			result = parseMgr.rebind();
+		}
+
+		result = result && generate(cmdLine, &module, &parseMgr, parseCache, isVerbose);
 		if (!result) {
-			printf("warning: %s\n", err::getLastErrorDescription().sz());
-			continue;
+			fprintf(stderr, "error: %s\n", err::getLastErrorDescription().sz());
+		} else if (!isVerbose) {
+			printf(
+				"Regenerated in %d ms (%d file(s) parsed)\n",
+				(int)((sys::getTimestamp() - timestamp) / 10000), // 100-nsec intervals
+				(int)parseMgr.getParsedFileCount()
+			);
 		}
 
-		while (fileEnum.hasNextFile()) {
-			sl::String filePath = dir + fileEnum.getNextFileName();
-			if (io::isDir(filePath))
-				continue;
+		isVerbose = false;
 
-			size_t length = filePath.getLength();
-			if (length < SuffixLength)
-				continue;
+		printf("Watching for changes...\n");
 
-			const char* suffix = filePath.sz() + length - SuffixLength;
+		result = watcher.wait(&fileNameList);
+		if (!result)
+			return false;
 
-			if (memcmp(suffix, luaSuffix, SuffixLength) == 0 ||
-				memcmp(suffix, doxSuffix, SuffixLength) == 0) {
-				result = parseFile(filePath, &module);
-				if (!result)
-					return false;
+		if (fileNameList.isEmpty()) {
+			printf("Rescanning source files...\n");
+			isRescanNeeded = true;
+		}
+
+		it = fileNameList.getHead();
+		for (; it; it++)
+			printf("Modified %s\n", it->sz());
+	}
+}
+
+// lexes sources over and over for at least a second; returns tokens per second
+
+double
+measureLexerThroughput(
+	const sl::BoxList<sl::String>& sourceList,
+	const ScanFuncTable* scanFuncTable
+) {
+	enum {
+		MinDuration = 10000000, // 1 sec in 100-nsec intervals
+	};
+
+	uint64_t tokenCount = 0;
+	uint64_t startTimestamp = sys::getTimestamp();
+	uint64_t duration;
+
+	do {
+		sl::ConstBoxIterator<sl::String> it = sourceList.getHead();
+		for (; it; it++) {
+			Lexer lexer;
+			lexer.m_scanFuncTable = scanFuncTable;
+			lexer.create(*it);
+
+			while (lexer.getToken()->m_token != TokenKind_Eof) {
+				lexer.nextToken();
+				tokenCount++;
 			}
 		}
+
+		duration = sys::getTimestamp() - startTimestamp;
+	} while (duration < MinDuration);
+
+	return tokenCount * 10000000.0 / duration;
+}
+
+bool
+benchLexer(CmdLine* cmdLine) {
+	bool result;
+
+	sl::BoxList<sl::String> sourceList;
+	size_t totalSize = 0;
+
+	sl::ConstBoxIterator<sl::String> it = cmdLine->m_inputFileNameList.getHead();
+	for (; it; it++) {
+		SourceFile file;
+		result = file.open(*it);
+		if (!result)
+			return false;
+
+		sourceList.insertTail(file.getSource());
+		totalSize += file.getSize();
 	}
 
-	if (cmdLine->m_flags & CmdLineFlag_DoxygenFilter)
-		module.generateDoxygenFilterOutput();
+	double scalarThroughput = measureLexerThroughput(sourceList, &g_scalarScanFuncTable);
+	double vectorThroughput = measureLexerThroughput(sourceList, &g_vectorScanFuncTable);
 
-	if (cmdLine->m_outputFileName.isEmpty())
+	printf(
+		"Lexed %d file(s), %d bytes\n"
+		"Scalar scans:     %.0f tokens/sec\n"
+		"Vectorized scans: %.0f tokens/sec (x%.2f)\n",
+		(int)sourceList.getCount(),
+		(int)totalSize,
+		scalarThroughput,
+		vectorThroughput,
+		vectorThroughput / scalarThroughput
+	);
+
+	return true;
+}
+
+// returns tokens/sec; parseTime receives the time of one pass (in msec)
+
+double
+measureParserThroughput(
+	Module* module,
+	const sl::BoxList<sl::String>& sourceList,
+	double* parseTime
+) {
+	enum {
+		MinDuration = 2500000, // 0.25 sec in 100-nsec intervals
+	};
+
+	uint64_t tokenCount = 0;
+	size_t passCount = 0;
+	uint64_t startTimestamp = sys::getTimestamp();
+	uint64_t duration;
+
+	do {
+		sl::ConstBoxIterator<sl::String> it = sourceList.getHead();
+		for (; it; it++) {
+			Unit unit(module);
+			unit.m_fileName = "<bench>";
+			unit.m_source.copy(*it);
+
+			bool result = parseUnit(&unit);
+			if (!result)
+				return -1;
+
+			tokenCount += unit.m_tokenCount;
+		}
+
+		passCount++;
+		duration = sys::getTimestamp() - startTimestamp;
+	} while (duration < MinDuration);
+
+	*parseTime = duration / (passCount * 10000.0);
+	return tokenCount * 10000000.0 / duration;
+}
+
+// generated code may contain very long chains of binary operators (e.g.
+// string concatenations); parse such chains of increasing lengths, then
+// the input files (if any)
+
+bool
+benchParser(CmdLine* cmdLine) {
+	enum {
+		MinOpCount = 1000,
+		MaxOpCount = 100000, // keeps the whole run within a few seconds
+	};
+
+	static const char* const opTable[] = {
+		"..", "+", "*", "-", "/", "^", "==", "and", "or",
+	};
+
+	bool result;
+
+	DoxyHost doxyHost;
+	Module module(&doxyHost);
+	doxyHost.setup(&module);
+
+	double throughput;
+	double parseTime;
+
+	for (size_t opCount = MinOpCount; opCount <= MaxOpCount; opCount *= 10) {
+		sl::String source = "local s = a";
+		for (size_t i = 0; i < opCount; i++)
+			source.appendFormat(" %s a", opTable[i % countof(opTable)]);
+
+		source += '\n';
+
+		sl::BoxList<sl::String> sourceList;
+		sourceList.insertTail(source);
+
+		throughput = measureParserThroughput(&module, sourceList, &parseTime);
+		if (throughput < 0)
+			return false;
+
+		printf(
+			"%7d operators: %9.3f ms/chain, %.0f tokens/sec\n",
+			(int)opCount,
+			parseTime,
+			throughput
+		);
+	}
+
+	if (cmdLine->m_inputFileNameList.isEmpty())
 		return true;
 
-	sl::String outputFileName = io::getFileName(cmdLine->m_outputFileName);
-	sl::String outputDir = io::getDir(cmdLine->m_outputFileName);
+	sl::BoxList<sl::String> sourceList;
+	size_t totalSize = 0;
+
+	sl::ConstBoxIterator<sl::String> it = cmdLine->m_inputFileNameList.getHead();
+	for (; it; it++) {
+		SourceFile file;
+		result = file.open(*it);
+		if (!result)
+			return false;
 
-	module.m_doxyModule.generateDocumentation(outputDir, outputFileName);
+		sourceList.insertTail(file.getSource());
+		totalSize += file.getSize();
+	}
+
+	throughput = measureParserThroughput(&module, sourceList, &parseTime);
+	if (throughput < 0)
+		return false;
+
+	printf(
+		"Parsed %d file(s), %d bytes: %.3f ms, %.0f tokens/sec\n",
+		(int)sourceList.getCount(),
+		(int)totalSize,
+		parseTime,
+		throughput
+	);
 
 	return true;
 }
 
+bool
+run(CmdLine* cmdLine) {
+	bool result;
+
+	if (cmdLine->m_flags & CmdLineFlag_BenchLexer)
+		return benchLexer(cmdLine);
+
+	if (cmdLine->m_flags & CmdLineFlag_BenchParser)
+		return benchParser(cmdLine);
+
+	if (cmdLine->m_flags & CmdLineFlag_FilterServer) {
+		FilterServer server;
+		return
+			server.listen(cmdLine->m_socketPath) &&
+			server.run();
+	}
+
+	if (cmdLine->m_flags & CmdLineFlag_FilterClient) {
+		FilterClient client;
+		if (cmdLine->m_inputFileNameList.getCount() == 1 &&
+			client.connect(cmdLine->m_socketPath))
+			return client.filter(*cmdLine->m_inputFileNameList.getHead());
+
+		// no server is running -- filter in-process
+	}
+
+	ParseCache parseCache;
+	if (!cmdLine->m_cacheDir.isEmpty()) {
+		result = parseCache.open(cmdLine->m_cacheDir);
+		if (!result)
+			return false;
+	}
+
+	return (cmdLine->m_flags & CmdLineFlag_Watch) ?
+		watch(cmdLine, &parseCache) :
+		build(cmdLine, &parseCache, !(cmdLine->m_flags & CmdLineFlag_DoxygenFilter));
+}
+
 //..............................................................................
 
 #if (_AXL_OS_WIN)
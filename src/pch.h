@@ -11,6 +11,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <new>
+
 #include "axl_sl_CmdLineParser.h"
 #include "axl_lex_RagelLexer.h"
 #include "axl_dox_Module.h"
@@ -19,6 +22,10 @@
 #include "axl_io_MappedFile.h"
 #include "axl_io_FilePathUtils.h"
 #include "axl_io_FileEnumerator.h"
+#include "axl_sys_Thread.h"
+#include "axl_sys_Event.h"
+#include "axl_sys_Atomic.h"
+#include "axl_g_Module.h"
 #include "llk_Parser.h"
 
 using namespace axl;